@@ -1,3 +1,4 @@
+#define _GNU_SOURCE
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
@@ -5,14 +6,54 @@
 #include <sys/wait.h>
 #include <sys/time.h>
 #include <string.h>
+#include <limits.h>
+#include <errno.h>
+#include <stdint.h>
+#include <stdatomic.h>
 #include <time.h>
 #include <signal.h>
 #include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <math.h>
+#include <ucontext.h>
 #include <sqlite3.h>
 
 #define MAX_PROCESSES 10
 #define MS_PER_SECOND 1000
 #define MAX_GANTT_WIDTH 100
+#define COROUTINE_STACK_SIZE (256 * 1024)
+#define TRACE_RING_SIZE 4096
+#define MAX_EVENTS 1000
+#define IO_POLL_INTERVAL_US 200
+#define MAX_SWEEP_POINTS 32
+#define SWEEP_REFINE_ROUNDS 2
+#define SWEEP_PLOT_WIDTH 50
+#define METRICS_SHM_NAME "/process_scheduler_metrics"
+#define METRICS_MAX_PROCESSES 64
+#define METRICS_PUBLISH_INTERVAL_MS 100
+#define MONITOR_REFRESH_MS 500
+#define QUEUE_SERIES_POINTS 60
+#define QUEUE_SAMPLE_INTERVAL_MS 50
+#define MAX_LOAD_JOBS 500
+#define MAX_LOAD_STEPS 16
+#define KNEE_THROUGHPUT_RATIO 0.9
+#define KNEE_LATENCY_FACTOR 5.0
+#define MAX_COMMAND_LENGTH 256
+#define MAX_COMMAND_ARGS 32
+#define BURST_HISTORY_FILE ".burst_history"
+#define BURST_HISTORY_ALPHA 0.5
+#define DEFAULT_BURST_ESTIMATE_MS 1000
+#define CGROUP_MOUNT "/sys/fs/cgroup"
+#define CGROUP_FREEZE_TIMEOUT_US 10000
+#define CGROUP_PATH_LENGTH 1024
+#define STATS_SNAPSHOT_INTERVAL_MS 1000
+#define QUANTILE_MARKERS 5
+#define SCHEDULE_LOG_MAGIC 0x4C525350  /* "PSRL" */
+#define SCHEDULE_LOG_VERSION 3
+#define SCHEDULE_LOG_IO_AWARE 0x1   /* Run modelled blocking I/O */
+#define SCHEDULE_LOG_CGROUP 0x2     /* Run preempted through cgroup.freeze */
 
 /* Structure to track execution events for Gantt chart visualization
  * Records the task type, process name, and timing information
@@ -39,10 +80,19 @@ typedef struct {
     double completion_time;  // Time when process completes
     double waiting_time;     // Total time spent waiting
     double turnaround_time;  // Total time in system
+    double response_time;    // Time from arrival to first execution
+    double service_time;     // CPU demand of synthetic tasks (ms)
     char task_type[20];      // Type of task
     void (*task_function)(); // Pointer to task implementation
+    char command[MAX_COMMAND_LENGTH]; // Command line of external tasks, empty for built-ins
     int is_active;          // Flag for process state
     int first_run;          // Flag for first execution
+    int cgroup_attached;    // Process runs in its own leaf cgroup
+    int slices;             // Slices dispatched in the last run
+    int traced_slices;      // Slices with on-CPU and I/O time from the trace
+    double scheduled_time;  // Time dispatched in the last run (ms)
+    double cpu_time;        // Traced on-CPU time in the last run (ms)
+    double io_time;         // Traced blocking I/O time in the last run (ms)
 } Process;
 
 /* Structure for inter-process communication and control
@@ -52,12 +102,260 @@ typedef struct {
 typedef struct {
     volatile sig_atomic_t should_run;  // Control flag for process execution
     volatile sig_atomic_t progress;    // Track task progress
-    volatile sig_atomic_t quantum;     // Time quantum for scheduling
+    volatile double quantum;           // Time quantum for scheduling (ms)
+    volatile double resume_time;       // Monotonic time (ms) at which the task last resumed
     int isPreemptive;                 // Flag for preemptive scheduling
+    int io_aware;                     // Stop after blocking I/O until dispatched again
+    volatile double service_time;      // CPU demand of synthetic tasks (ms)
 } ProcessControl;
 
 ProcessControl* process_control;
 
+/* Structure for a task running as a stackful coroutine
+ * Used by the in-process backend, where tasks share the scheduler's
+ * address space and are switched with swapcontext instead of signals
+ */
+typedef struct {
+    ucontext_t context;        // Saved register state of the task
+    void* stack;               // Stack the task runs on
+    void (*task_function)();   // Task implementation to run
+    int finished;              // Set once the task function returns
+} Coroutine;
+
+ucontext_t scheduler_context;
+Coroutine* current_coroutine = NULL;
+
+/* Structure to accumulate context switch overhead
+ * Latency is the time between the scheduler dispatching a task
+ * and the task observing that it has resumed
+ */
+typedef struct {
+    int switches;              // Number of dispatches performed
+    int latency_samples;       // Dispatches where the task reported its resume time
+    double total_latency;      // Sum of dispatch latencies (ms)
+} SwitchStats;
+
+SwitchStats switch_stats;
+
+/* Trace record types written by tasks into their trace ring
+ * Mark the points where a task starts or stops using the CPU
+ */
+typedef enum {
+    TRACE_START,       // Task function entered
+    TRACE_RESUME,      // Task resumed after a quantum checkpoint
+    TRACE_CHECKPOINT,  // Task yielding at a quantum checkpoint
+    TRACE_IO_BEGIN,    // Task about to block on I/O
+    TRACE_IO_END,      // Task returned from blocking I/O
+    TRACE_EXIT         // Task function returned
+} TraceType;
+
+/* Fixed-size binary trace record
+ * Timestamps use the monotonic clock so parent and child agree
+ */
+typedef struct {
+    double timestamp;    // Monotonic time (ms) of the event
+    int32_t progress;    // Task progress at the event
+    int32_t type;        // One of TraceType
+} TraceRecord;
+
+/* Single-producer single-consumer ring shared with one task
+ * The task only advances head and the scheduler only advances tail,
+ * so neither side needs a lock
+ */
+typedef struct {
+    _Atomic uint32_t head;      // Next slot written by the task
+    _Atomic uint32_t tail;      // Next slot read by the scheduler
+    _Atomic uint32_t dropped;   // Records lost because the ring was full
+    TraceRecord records[TRACE_RING_SIZE];
+} TraceRing;
+
+/* Scheduler-side state built from a task's trace records
+ * Converts the record stream into on-CPU and I/O time per slice
+ */
+typedef struct {
+    int on_cpu;          // Task is currently executing
+    int in_io;           // Task is currently blocked on I/O
+    int exited;          // Task reported TRACE_EXIT
+    double cpu_since;    // Start of the open on-CPU interval (ms)
+    double io_since;     // Start of the open I/O interval (ms)
+    double cpu_time;     // On-CPU time within the current slice (ms)
+    double io_time;      // I/O time within the current slice (ms)
+} TraceAccumulator;
+
+TraceRing* trace_rings = NULL;          // One ring per process, shared with children
+TraceRing* current_trace_ring = NULL;   // Ring of the task running in this context
+unsigned int trace_dropped = 0;         // Records dropped during the last run
+
+/* Scheduling state of a process in the I/O-aware scheduler
+ */
+typedef enum {
+    PROC_NEW,          // Not yet arrived
+    PROC_READY,        // Waiting in the ready queue
+    PROC_RUNNING,      // Dispatched on the CPU
+    PROC_BLOCKED,      // Waiting for blocking I/O to complete
+    PROC_DONE          // Exited
+} ProcessState;
+
+/* Structure to accumulate CPU and I/O overlap for a run
+ * Filled in by the I/O-aware scheduler
+ */
+typedef struct {
+    double io_time;        // Total time processes spent blocked on I/O (ms)
+    double io_active;      // Time at least one process was blocked (ms)
+    double io_overlap;     // Time the CPU was busy while I/O was in flight (ms)
+} IOStats;
+
+IOStats io_stats;
+
+/* Live state of one process as published to the monitor
+ */
+typedef struct {
+    char process_name[8];      // Process name identifier
+    char task_type[20];        // Type of task
+    int state;                 // One of ProcessState
+    int progress;              // Task progress counter
+    double cpu_time;           // CPU time dispatched so far (ms)
+} ProcessMetrics;
+
+/* Shared-memory segment with live counters of a running simulation
+ * Protected by a seqlock: the scheduler makes the sequence odd while it
+ * writes, and readers retry when the sequence is odd or has changed
+ */
+typedef struct {
+    _Atomic uint32_t sequence;     // Seqlock sequence number
+    int active;                    // A run is in progress
+    pid_t scheduler_pid;           // PID of the publishing scheduler
+    char policy[32];               // Name of the running policy
+    double elapsed;                // Time since the run started (ms)
+    int running;                   // Index of the running process, -1 if idle
+    int ready_count;               // Processes in the ready queue
+    int blocked_count;             // Processes blocked on I/O
+    int completed;                 // Processes that have exited
+    int process_count;             // Processes in the run
+    int switches;                  // Dispatches so far
+    double switches_per_sec;       // Dispatch rate over the last interval
+    ProcessMetrics processes[METRICS_MAX_PROCESSES];
+} LiveMetrics;
+
+LiveMetrics* live_metrics = NULL;       // Published when started with --metrics
+
+/* State of the cgroup v2 preemption backend
+ * Each scheduled process gets a leaf cgroup below path, named after its PID
+ */
+typedef struct {
+    int enabled;               // Preempt through cgroup.freeze instead of SIGSTOP
+    pid_t owner;               // Scheduler process that created path
+    char path[CGROUP_PATH_LENGTH];   // Cgroup directory owned by this scheduler
+} CgroupBackend;
+
+CgroupBackend cgroup_backend;
+
+/* Structure to track the ready queue length over a run
+ * The series keeps a fixed number of points and halves its resolution
+ * whenever it fills up, so it covers runs of any length
+ */
+typedef struct {
+    double area;                       // Integral of queue length over time
+    double duration;                   // Time covered by the samples (ms)
+    int max_length;                    // Longest queue seen
+    int series[QUEUE_SERIES_POINTS];   // Queue length sampled over the run
+    int series_count;                  // Points stored in series
+    double series_interval;            // Time between series points (ms)
+    double next_sample;                // Run time of the next series point (ms)
+} QueueStats;
+
+QueueStats queue_stats;
+
+/* P-square estimator of one quantile (Jain and Chlamtac, 1985)
+ * Keeps five markers whose heights track the minimum, p/2, p, (1+p)/2
+ * and maximum quantiles, so no samples are retained
+ */
+typedef struct {
+    double p;                                  // Quantile being estimated (0-1)
+    long count;                                // Observations seen
+    double height[QUANTILE_MARKERS];           // Marker heights
+    double position[QUANTILE_MARKERS];         // Actual marker positions
+    double desired[QUANTILE_MARKERS];          // Desired marker positions
+} QuantileEstimator;
+
+/* Running summary of one metric, updated one observation at a time
+ * Mean and variance use Welford's method; the sums feed fairness indices
+ */
+typedef struct {
+    long count;                // Observations seen
+    double mean;               // Running mean
+    double m2;                 // Sum of squared deviations from the mean
+    double min;                // Smallest observation
+    double max;                // Largest observation
+    double sum;                // Sum of observations
+    double sum_squares;        // Sum of squared observations
+    QuantileEstimator p50, p95, p99;
+} RunningStats;
+
+/* Statistics of a run, fed as processes complete and slices end
+ * Nothing is kept per process, so runs of any size fit in constant memory
+ */
+typedef struct {
+    RunningStats turnaround;       // Completion minus arrival (ms)
+    RunningStats waiting;          // Turnaround minus measured burst (ms)
+    RunningStats response;         // First dispatch minus arrival (ms)
+    RunningStats slowdown;         // Turnaround divided by measured burst
+    RunningStats service_rate;     // Measured burst divided by turnaround, for Jain's index
+    RunningStats slice;            // Length of each dispatched slice (ms)
+    long negative_waits;           // Completions with negative waiting time
+    double next_snapshot;          // Run time of the next snapshot (ms)
+} StreamStats;
+
+StreamStats stream_stats;
+
+/* Header of a recorded scheduling run
+ * Followed by process_count process records and decision_count decisions
+ */
+typedef struct {
+    uint32_t magic;            // SCHEDULE_LOG_MAGIC
+    uint32_t version;          // SCHEDULE_LOG_VERSION
+    int32_t algorithm;         // Menu choice used for the run
+    int32_t quantum;           // Time quantum entered for the run, 0 if unused
+    uint32_t seed;             // Seed used by the tasks' random data
+    int32_t process_count;     // Number of process records
+    int32_t decision_count;    // Number of decision records
+    uint32_t flags;            // SCHEDULE_LOG_* mode of the run
+} ScheduleLogHeader;
+
+/* Workload entry and outcome of one process in a recorded run
+ */
+typedef struct {
+    char process_name[5];      // Process name identifier
+    char task_type[20];        // Type of task
+    int32_t arrival_time;      // Time when process arrives (ms)
+    double burst_time;         // Measured burst time (ms)
+    double completion_time;    // Time when process completed (ms)
+    double turnaround_time;    // Total time in system (ms)
+    double waiting_time;       // Total time spent waiting (ms)
+    char command[MAX_COMMAND_LENGTH];  // Command line of external tasks, empty for built-ins
+} ScheduleLogProcess;
+
+/* How a recorded slice ended
+ */
+typedef enum {
+    SLICE_PREEMPTED,   // Stopped by the scheduler or at a quantum checkpoint
+    SLICE_COMPLETED,   // Process exited
+    SLICE_BLOCKED      // Process blocked on I/O (I/O-aware runs only)
+} SliceOutcome;
+
+/* One scheduling decision: which process ran, for how long,
+ * and how the slice ended
+ */
+typedef struct {
+    int16_t process_index;     // Index into the process records
+    uint8_t outcome;           // One of SliceOutcome
+    double start_time;         // Start time of the slice (ms)
+    double end_time;           // End time of the slice (ms)
+} ScheduleLogDecision;
+
+unsigned int simulation_seed = 0;       // Seed for the tasks' random data
+char command_dir[PATH_MAX] = "";        // Directory external commands run from, empty for the current one
+
 /* Signal handler for stopping processes
  * Called when a process needs to be interrupted
  */
@@ -65,23 +363,173 @@ ProcessControl* process_control;
  //   process_control->should_run = 0;
 //}
 
-ExecutionEvent events[1000];
+ExecutionEvent events[MAX_EVENTS];
 int event_count = 0;
 
-/* Records an execution event for Gantt chart visualization
- * Stores timing and process information for each execution segment
+/* Totals over every slice of a run
+ * Unlike the event timeline, which stops at MAX_EVENTS, these cover the whole run
+ */
+typedef struct {
+    int slices;            // Slices dispatched
+    int traced_slices;     // Slices with on-CPU time from the trace
+    double dispatched;     // Time processes were dispatched (ms)
+    double on_cpu;         // Traced on-CPU time (ms)
+    double last_end;       // End time of the latest slice (ms)
+} RunTotals;
+
+RunTotals run_totals;
+
+/* Clears the event timeline and the slice totals at the start of a run
+ */
+void reset_events(Process processes[], int n) {
+    event_count = 0;
+    memset(&run_totals, 0, sizeof(run_totals));
+    for (int i = 0; i < n; i++) {
+        processes[i].slices = 0;
+        processes[i].traced_slices = 0;
+        processes[i].scheduled_time = 0;
+        processes[i].cpu_time = 0;
+        processes[i].io_time = 0;
+    }
+}
+
+/* Records an execution segment of a process
+ * Adds it to the run and process totals, and to the Gantt chart
+ * timeline while there is room. trace is NULL for untraced slices
  */
 
-void record_event(const char* task_type, const char* process_name, double start_time, double end_time) {
-    if (event_count < 1000) {
-        strcpy(events[event_count].task_type, task_type);
-        strcpy(events[event_count].process_name, process_name);
+void record_event(Process* p, double start_time, double end_time, const TraceAccumulator* trace) {
+    p->slices++;
+    p->scheduled_time += end_time - start_time;
+    run_totals.slices++;
+    run_totals.dispatched += end_time - start_time;
+    if (end_time > run_totals.last_end) run_totals.last_end = end_time;
+    if (trace != NULL) {
+        p->traced_slices++;
+        p->cpu_time += trace->cpu_time;
+        p->io_time += trace->io_time;
+        run_totals.traced_slices++;
+        run_totals.on_cpu += trace->cpu_time;
+    }
+
+    if (event_count < MAX_EVENTS) {
+        strcpy(events[event_count].task_type, p->task_type);
+        strcpy(events[event_count].process_name, p->process_name);
         events[event_count].start_time = start_time;
         events[event_count].end_time = end_time;
         event_count++;
     }
 }
 
+/* Schedule log being written while a run is recorded
+ * Decisions are appended as they are made; the header and process
+ * records are rewritten with the outcome when the run finishes
+ */
+typedef struct {
+    FILE* fp;                  // Open log, NULL when not recording
+    const char* path;          // Path of the log
+    int decision_count;        // Decisions appended so far
+} ScheduleRecorder;
+
+ScheduleRecorder schedule_recorder;
+
+/* Writes the header and one record per process at the current position
+ */
+void write_schedule_log_head(int algorithm, int quantum, int io_aware,
+                             Process processes[], int n) {
+    ScheduleLogHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = SCHEDULE_LOG_MAGIC;
+    header.version = SCHEDULE_LOG_VERSION;
+    header.algorithm = algorithm;
+    header.quantum = quantum;
+    header.seed = simulation_seed;
+    header.process_count = n;
+    header.decision_count = schedule_recorder.decision_count;
+    header.flags = (io_aware ? SCHEDULE_LOG_IO_AWARE : 0) |
+                   (cgroup_backend.enabled ? SCHEDULE_LOG_CGROUP : 0);
+    fwrite(&header, sizeof(header), 1, schedule_recorder.fp);
+
+    for (int i = 0; i < n; i++) {
+        ScheduleLogProcess record;
+        memset(&record, 0, sizeof(record));
+        strcpy(record.process_name, processes[i].process_name);
+        strcpy(record.task_type, processes[i].task_type);
+        record.arrival_time = processes[i].arrival_time;
+        record.burst_time = processes[i].burst_time;
+        record.completion_time = processes[i].completion_time;
+        record.turnaround_time = processes[i].turnaround_time;
+        record.waiting_time = processes[i].waiting_time;
+        strcpy(record.command, processes[i].command);
+        fwrite(&record, sizeof(record), 1, schedule_recorder.fp);
+    }
+}
+
+/* Opens a schedule log and writes the workload of the run
+ * Processes must be in the order the scheduler will index them
+ */
+int begin_schedule_log(const char* path, Process processes[], int n) {
+    schedule_recorder.fp = fopen(path, "wb");
+    if (schedule_recorder.fp == NULL) {
+        perror("Cannot open schedule log");
+        return -1;
+    }
+    schedule_recorder.path = path;
+    schedule_recorder.decision_count = 0;
+    write_schedule_log_head(0, 0, 0, processes, n);
+    fflush(schedule_recorder.fp);
+    return 0;
+}
+
+/* Appends one scheduling decision to the log being recorded
+ * Called by the schedulers at the end of every slice
+ */
+void log_decision(int process_index, SliceOutcome outcome, double start_time, double end_time) {
+    if (schedule_recorder.fp == NULL) return;
+
+    ScheduleLogDecision decision;
+    memset(&decision, 0, sizeof(decision));
+    decision.process_index = process_index;
+    decision.outcome = outcome;
+    decision.start_time = start_time;
+    decision.end_time = end_time;
+    fwrite(&decision, sizeof(decision), 1, schedule_recorder.fp);
+    /* Keep the buffer empty so forked tasks cannot flush a copy of it on exit */
+    fflush(schedule_recorder.fp);
+    schedule_recorder.decision_count++;
+}
+
+/* Completes the log of a finished run
+ * Rewrites the header and process records with the outcome of the run
+ */
+int finish_schedule_log(int algorithm, int quantum, int io_aware, Process processes[], int n) {
+    if (schedule_recorder.fp == NULL) return 0;
+
+    rewind(schedule_recorder.fp);
+    write_schedule_log_head(algorithm, quantum, io_aware, processes, n);
+
+    int failed = ferror(schedule_recorder.fp);
+    if (fclose(schedule_recorder.fp) != 0) failed = 1;
+    schedule_recorder.fp = NULL;
+    if (failed) {
+        fprintf(stderr, "Failed to write schedule log %s\n", schedule_recorder.path);
+        return -1;
+    }
+
+    printf("\nRecorded %d scheduling decisions to %s\n",
+           schedule_recorder.decision_count, schedule_recorder.path);
+    return 0;
+}
+
+/* Closes and removes the log of a run that did not complete
+ */
+void discard_schedule_log() {
+    if (schedule_recorder.fp == NULL) return;
+    fclose(schedule_recorder.fp);
+    schedule_recorder.fp = NULL;
+    unlink(schedule_recorder.path);
+}
+
 /* Generates and prints a Gantt chart visualization
  * Shows the execution timeline of all processes
  */
@@ -137,6 +585,9 @@ void print_gantt_chart() {
         printf("%s", time_str);
     }
     printf("\n");
+    if (run_totals.slices > event_count) {
+        printf("(chart shows the first %d of %d slices)\n", event_count, run_totals.slices);
+    }
 
     free(block_widths);
 }
@@ -151,6 +602,16 @@ double get_current_time() {
     return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
 }
 
+/* Gets monotonic time in milliseconds
+ * Comparable across processes, used for context switch measurements
+ */
+
+double get_monotonic_time() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
 /* Implements milliexplain the second-precision sleep
  * Used for controlled process delays
  */
@@ -158,6 +619,164 @@ double get_current_time() {
 void sleep_ms(int milliseconds) {
     usleep(milliseconds * 1000);
 }
+
+/* Appends a trace record to the running task's ring
+ * Drops the record instead of blocking when the ring is full
+ */
+
+void trace_emit(TraceType type) {
+    TraceRing* ring = current_trace_ring;
+    if (ring == NULL) return;
+
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    if (head - tail >= TRACE_RING_SIZE) {
+        atomic_fetch_add_explicit(&ring->dropped, 1, memory_order_relaxed);
+        return;
+    }
+
+    TraceRecord* record = &ring->records[head % TRACE_RING_SIZE];
+    record->timestamp = get_monotonic_time();
+    record->progress = process_control ? process_control->progress : 0;
+    record->type = type;
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+}
+
+/* Maps shared trace rings for n processes
+ * Children inherit the mapping across fork()
+ */
+
+TraceRing* create_trace_rings(int n) {
+    TraceRing* rings = mmap(NULL, sizeof(TraceRing) * n, 
+                           PROT_READ | PROT_WRITE, 
+                           MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (rings == MAP_FAILED) {
+        perror("mmap failed");
+        return NULL;
+    }
+    return rings;
+}
+
+/* Unmaps trace rings and keeps the count of dropped records
+ */
+
+void destroy_trace_rings(TraceRing* rings, int n) {
+    if (rings == NULL) return;
+    trace_dropped = 0;
+    for (int i = 0; i < n; i++) {
+        trace_dropped += atomic_load(&rings[i].dropped);
+    }
+    munmap(rings, sizeof(TraceRing) * n);
+}
+
+/* Consumes all pending records from a task's ring
+ * Updates the accumulator with the on-CPU and I/O intervals they close
+ */
+
+void drain_trace_ring(TraceRing* ring, TraceAccumulator* acc) {
+    if (ring == NULL) return;
+
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+
+    for (; tail != head; tail++) {
+        TraceRecord* record = &ring->records[tail % TRACE_RING_SIZE];
+        double t = record->timestamp;
+
+        switch (record->type) {
+            case TRACE_IO_END:
+                if (acc->in_io) {
+                    acc->io_time += t - acc->io_since;
+                    acc->in_io = 0;
+                }
+                /* fall through */
+            case TRACE_START:
+            case TRACE_RESUME:
+                if (!acc->on_cpu) {
+                    acc->on_cpu = 1;
+                    acc->cpu_since = t;
+                }
+                break;
+            case TRACE_CHECKPOINT:
+            case TRACE_IO_BEGIN:
+            case TRACE_EXIT:
+                if (acc->on_cpu) {
+                    acc->cpu_time += t - acc->cpu_since;
+                    acc->on_cpu = 0;
+                }
+                if (record->type == TRACE_IO_BEGIN) {
+                    acc->in_io = 1;
+                    acc->io_since = t;
+                } else if (record->type == TRACE_EXIT) {
+                    acc->exited = 1;
+                }
+                break;
+        }
+    }
+
+    atomic_store_explicit(&ring->tail, tail, memory_order_release);
+}
+
+/* Starts a new slice for a task at the given monotonic time
+ * Intervals left open by an external SIGSTOP restart here
+ */
+
+void trace_begin_slice(TraceAccumulator* acc, double dispatch_time) {
+    acc->cpu_time = 0;
+    acc->io_time = 0;
+    acc->cpu_since = dispatch_time;
+    acc->io_since = dispatch_time;
+}
+
+/* Ends the current slice at the given monotonic time
+ * Drains remaining records and closes intervals still open
+ */
+
+void trace_end_slice(TraceRing* ring, TraceAccumulator* acc, double end_time) {
+    drain_trace_ring(ring, acc);
+    if (acc->on_cpu && end_time > acc->cpu_since) {
+        acc->cpu_time += end_time - acc->cpu_since;
+    }
+    if (acc->in_io && end_time > acc->io_since) {
+        acc->io_time += end_time - acc->io_since;
+    }
+}
+
+/* Sleeps on behalf of a task to simulate blocking I/O
+ * Brackets the sleep with trace records so it is not counted as CPU time.
+ * Returns 1 if the task stopped until dispatched again, so that the caller
+ * restarts its quantum from the new dispatch
+ */
+
+int io_sleep(int microseconds) {
+    trace_emit(TRACE_IO_BEGIN);
+    usleep(microseconds);
+    trace_emit(TRACE_IO_END);
+    if (process_control != NULL && process_control->io_aware) {
+        raise(SIGSTOP);
+        process_control->resume_time = get_monotonic_time();
+        return 1;
+    }
+    return 0;
+}
+
+/* Gives up the CPU at a quantum checkpoint
+ * Switches back to the scheduler when running as a coroutine,
+ * otherwise stops the process until the scheduler sends SIGCONT
+ */
+
+void task_yield() {
+    if (!process_control->isPreemptive) return;
+
+    trace_emit(TRACE_CHECKPOINT);
+    if (current_coroutine != NULL) {
+        swapcontext(&current_coroutine->context, &scheduler_context);
+    } else {
+        raise(SIGSTOP);
+    }
+    process_control->resume_time = get_monotonic_time();
+    trace_emit(TRACE_RESUME);
+}
 /* Task implementation: File writing operation
  * Writes sequential lines to an output file
  */
@@ -176,7 +795,7 @@ void task_file_write() {
             if (elapsed >= process_control->quantum) {
                 process_control->progress = i;
                 fclose(fp);
-                raise(SIGSTOP);  
+                task_yield();
                 fp = fopen("output.txt", "a");
                 if (fp == NULL) break;
 
@@ -185,7 +804,9 @@ void task_file_write() {
 
             fprintf(fp, "Process %d writing line %d\n", getpid(), i);
             fflush(fp);
-            usleep(1000); 
+            if (io_sleep(1000)) {
+                clock_gettime(CLOCK_MONOTONIC, &start);
+            }
         }
         fclose(fp);
     }
@@ -209,14 +830,16 @@ void task_console_echo() {
         if (elapsed >= process_control->quantum) {
 
             process_control->progress = i;
-            raise(SIGSTOP);
+            task_yield();
 
             clock_gettime(CLOCK_MONOTONIC, &start);
         }
 
         printf("Process %d echoing line %d\n", getpid(), i);
         fflush(stdout);
-        usleep(10000); 
+        if (io_sleep(10000)) {
+            clock_gettime(CLOCK_MONOTONIC, &start);
+        }
     }
 
     process_control->progress = 0;
@@ -255,7 +878,7 @@ void task_compute() {
                     exit(0);
                     break;
                 }
-                raise(SIGSTOP);
+                task_yield();
 
                 clock_gettime(CLOCK_MONOTONIC, &start);
             }
@@ -287,7 +910,7 @@ void task_db_write() {
         if (elapsed >= process_control->quantum) {
 
             process_control->progress = i;
-            raise(SIGSTOP);
+            task_yield();
 
             clock_gettime(CLOCK_MONOTONIC, &start);
         }
@@ -320,8 +943,6 @@ void task_db_write() {
         return;
     }
 
-    srand(time(NULL));
-
     pid = getpid();
 
     sqlite3_stmt *stmt;
@@ -336,7 +957,8 @@ void task_db_write() {
     char name[50];
     snprintf(name, sizeof(name), "name_%d", pid);
 
-    int age = 10 + rand() % 11;
+    unsigned int seed = simulation_seed + i;
+    int age = 10 + rand_r(&seed) % 11;
 
     sqlite3_bind_int(stmt, 1, i);
     sqlite3_bind_text(stmt, 2, name, -1, SQLITE_STATIC);
@@ -350,20 +972,97 @@ void task_db_write() {
     sqlite3_finalize(stmt);
     sqlite3_close(db);
 
-        usleep(10000); 
+        if (io_sleep(10000)) {
+            clock_gettime(CLOCK_MONOTONIC, &start);
+        }
     }
 
     process_control->progress = 0;
 }
+/* Task implementation: synthetic CPU burn
+ * Consumes service_time ms of CPU, used by the open-loop load generator
+ */
+void task_spin() {
+    struct timespec start, current, cpu;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    volatile long counter = 0;
+    while (1) {
+        for (int k = 0; k < 10000; k++) counter++;
+
+        clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &cpu);
+        double used = cpu.tv_sec * 1000.0 + cpu.tv_nsec / 1000000.0;
+        if (used >= process_control->service_time) break;
+
+        clock_gettime(CLOCK_MONOTONIC, &current);
+        double elapsed = (current.tv_sec - start.tv_sec) * 1000.0 + 
+                        (current.tv_nsec - start.tv_nsec) / 1000000.0;
+
+        if (elapsed >= process_control->quantum) {
+            process_control->progress = (int)used;
+            task_yield();
+            clock_gettime(CLOCK_MONOTONIC, &start);
+        }
+    }
+}
+/* Table of built-in task types
+ * Maps the task type names stored in logs back to their implementations
+ */
+typedef struct {
+    const char* name;          // Task type name
+    void (*task_function)();   // Task implementation
+} TaskType;
+
+TaskType task_types[] = {
+    {"file_write", task_file_write},
+    {"console_echo", task_console_echo},
+    {"compute", task_compute},
+    {"db_write", task_db_write},
+    {"spin", task_spin},
+};
+
+/* Looks up a task implementation by its type name
+ * Returns NULL for unknown task types
+ */
+void (*lookup_task_function(const char* name))() {
+    for (size_t i = 0; i < sizeof(task_types) / sizeof(task_types[0]); i++) {
+        if (strcmp(task_types[i].name, name) == 0) {
+            return task_types[i].task_function;
+        }
+    }
+    return NULL;
+}
+/* Returns the short name of a scheduling algorithm menu choice
+ */
+const char* algorithm_name(int algorithm) {
+    switch (algorithm) {
+        case 1: return "FCFS";
+        case 2: return "RR";
+        case 3: return "SJF";
+        case 4: return "RR-CO";
+        case 6: return "SRTF";
+        default: return "unknown";
+    }
+}
 /* Measures actual burst time for a given task
  * Creates test process and measures execution time
  */
 
 double measure_burst_time(void (*task_function)()) {
+    ProcessControl measure_control;
+    measure_control.should_run = 1;
+    measure_control.progress = 0;
+    measure_control.quantum = __DBL_MAX__;
+    measure_control.resume_time = 0;
+    measure_control.isPreemptive = 0;
+    measure_control.io_aware = 0;
+    measure_control.service_time = 0;
+
     double start_time = get_current_time();
 
     pid_t pid = fork();
     if (pid == 0) {
+        process_control = &measure_control;
         task_function();
         exit(0);
     } else if (pid > 0) {
@@ -391,384 +1090,2153 @@ void initialize_process(Process* p, void (*task_function)(), const char* task_na
     p->completion_time = 0;
     p->waiting_time = 0;
     p->turnaround_time = 0;
+    p->response_time = 0;
+    p->service_time = 0;
+    p->command[0] = '\0';
     p->pid = 0;
     p->is_active = 0;
+    p->cgroup_attached = 0;
     p->first_run = 1;
 
     printf("Measured burst time for %s (%s): %.2f ms\n", p->process_name, task_name, p->burst_time);
 }
-/* Creates a new process using fork()
- * Initializes child process for task execution
+/* Creates the shared-memory metrics segment for this scheduler
+ * Returns NULL if the segment cannot be created
  */
-
-void create_process(Process* p) {
-    pid_t pid = fork();
-
-    if (pid == 0) {
-        p->task_function();
-        exit(0);
-    } else if (pid > 0) {
-        p->pid = pid;
+LiveMetrics* create_live_metrics() {
+    int fd = shm_open(METRICS_SHM_NAME, O_CREAT | O_RDWR, 0644);
+    if (fd < 0) {
+        perror("shm_open failed");
+        return NULL;
+    }
+    if (ftruncate(fd, sizeof(LiveMetrics)) != 0) {
+        perror("ftruncate failed");
+        close(fd);
+        return NULL;
     }
-}
-/* Implements First-Come-First-Serve scheduling algorithm
- * Executes processes in order of arrival
- */
-void fcfs(Process processes[], int n) {
-    printf("\nExecuting FCFS Scheduling...\n");
-    event_count = 0;
 
-    process_control = mmap(NULL, sizeof(ProcessControl), 
-                         PROT_READ | PROT_WRITE, 
-                         MAP_SHARED | MAP_ANONYMOUS, -1, 0);
-    if (process_control == MAP_FAILED) {
+    LiveMetrics* metrics = mmap(NULL, sizeof(LiveMetrics), 
+                               PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (metrics == MAP_FAILED) {
         perror("mmap failed");
-        return;
+        return NULL;
     }
 
-    double current_time = 0;
-    for (int i = 0; i < n; i++) {
+    memset(metrics, 0, sizeof(LiveMetrics));
+    metrics->scheduler_pid = getpid();
+    metrics->running = -1;
+    return metrics;
+}
 
-        if (current_time < processes[i].arrival_time) {
-            sleep_ms(processes[i].arrival_time - current_time);
-            current_time = processes[i].arrival_time;
-        }
+/* Removes the metrics segment when the scheduler exits
+ * Registered with atexit(), so children that call exit() must skip it
+ */
+void unlink_live_metrics() {
+    if (live_metrics == NULL || live_metrics->scheduler_pid != getpid()) return;
+    munmap(live_metrics, sizeof(LiveMetrics));
+    live_metrics = NULL;
+    shm_unlink(METRICS_SHM_NAME);
+}
 
-        if (processes[i].first_run) {
-            processes[i].first_run = 0;
-        }
+/* Opens the seqlock for writing
+ */
+void metrics_write_begin(LiveMetrics* metrics) {
+    uint32_t sequence = atomic_load_explicit(&metrics->sequence, memory_order_relaxed);
+    atomic_store_explicit(&metrics->sequence, sequence + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+}
 
-        printf("Starting %s at time %.2f ms\n", processes[i].process_name, current_time);
+/* Closes the seqlock after writing
+ */
+void metrics_write_end(LiveMetrics* metrics) {
+    uint32_t sequence = atomic_load_explicit(&metrics->sequence, memory_order_relaxed);
+    atomic_store_explicit(&metrics->sequence, sequence + 1, memory_order_release);
+}
 
-        process_control->should_run = 1;
-        process_control->progress = 0;
-        process_control->quantum = processes[i].burst_time;  
-        process_control->isPreemptive=0;
+/* Copies a consistent snapshot of the metrics segment
+ * Retries while the scheduler is in the middle of an update
+ */
+void read_live_metrics(LiveMetrics* metrics, LiveMetrics* snapshot) {
+    while (1) {
+        uint32_t before = atomic_load_explicit(&metrics->sequence, memory_order_acquire);
+        if (before & 1) {
+            sched_yield();
+            continue;
+        }
+        memcpy((char*)snapshot + sizeof(snapshot->sequence),
+               (char*)metrics + sizeof(metrics->sequence),
+               sizeof(LiveMetrics) - sizeof(metrics->sequence));
+        atomic_thread_fence(memory_order_acquire);
+        uint32_t after = atomic_load_explicit(&metrics->sequence, memory_order_relaxed);
+        if (before == after) return;
+    }
+}
+/* Writes a value to a file in a cgroup directory
+ * Returns 0 on success and -1 with errno set on failure
+ */
+int cgroup_write(const char* dir, const char* file, const char* value) {
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s/%s", dir, file);
+
+    int fd = open(path, O_WRONLY);
+    if (fd < 0) return -1;
+    ssize_t written = write(fd, value, strlen(value));
+    int saved_errno = errno;
+    close(fd);
+    errno = saved_errno;
+    return written < 0 ? -1 : 0;
+}
 
-        double start_time = current_time;
-        create_process(&processes[i]);
+/* Builds the path of the leaf cgroup of a scheduled process
+ */
+void cgroup_leaf_path(pid_t pid, char* path, size_t size) {
+    snprintf(path, size, "%s/pid%d", cgroup_backend.path, (int)pid);
+}
 
-        int status;
-        struct timespec start_ts, current_ts;
-        clock_gettime(CLOCK_MONOTONIC, &start_ts);
+/* Removes the scheduler's cgroup directory when the scheduler exits
+ * Registered with atexit(), so children that call exit() must skip it
+ */
+void cgroup_backend_cleanup() {
+    if (!cgroup_backend.enabled || cgroup_backend.owner != getpid()) return;
+    rmdir(cgroup_backend.path);
+    cgroup_backend.enabled = 0;
+}
 
-        while (1) {
-            pid_t result = waitpid(processes[i].pid, &status, WNOHANG);
-            if (result > 0) break;  
+/* Sets up the cgroup v2 backend below the scheduler's own cgroup
+ * The parent cgroup can be overridden with PSS_CGROUP_ROOT; returns -1
+ * and leaves the signal backend in place when cgroup v2 is unavailable
+ */
+int cgroup_backend_init() {
+    char base[CGROUP_PATH_LENGTH - 32], controllers[PATH_MAX];
+    const char* root = getenv("PSS_CGROUP_ROOT");
+
+    /* On hybrid hosts v2 is mounted elsewhere, so check the given root itself */
+    snprintf(controllers, sizeof(controllers), "%s/cgroup.controllers",
+             root != NULL ? root : CGROUP_MOUNT);
+    if (access(controllers, F_OK) != 0) {
+        fprintf(stderr, "cgroup v2 is not mounted at %s\n", root != NULL ? root : CGROUP_MOUNT);
+        return -1;
+    }
 
-            clock_gettime(CLOCK_MONOTONIC, &current_ts);
-            usleep(1000);  
+    if (root != NULL) {
+        snprintf(base, sizeof(base), "%s", root);
+    } else {
+        FILE* fp = fopen("/proc/self/cgroup", "r");
+        char own[CGROUP_PATH_LENGTH / 2] = "";
+        if (fp != NULL) {
+            char line[CGROUP_PATH_LENGTH / 2];
+            while (fgets(line, sizeof(line), fp) != NULL) {
+                if (strncmp(line, "0::", 3) == 0) {
+                    line[strcspn(line, "\n")] = '\0';
+                    snprintf(own, sizeof(own), "%s", line + 3);
+                }
+            }
+            fclose(fp);
         }
+        snprintf(base, sizeof(base), "%s%s", CGROUP_MOUNT, strcmp(own, "/") == 0 ? "" : own);
+    }
 
-        clock_gettime(CLOCK_MONOTONIC, &current_ts);
-        double elapsed = (current_ts.tv_sec - start_ts.tv_sec) * 1000.0 + 
-                        (current_ts.tv_nsec - start_ts.tv_nsec) / 1000000.0;
-
-        current_time += elapsed;
-        record_event(processes[i].task_type, processes[i].process_name, start_time, current_time);
-
-        processes[i].completion_time = current_time;
-        processes[i].turnaround_time = processes[i].completion_time - processes[i].arrival_time;
-        processes[i].waiting_time = processes[i].turnaround_time - processes[i].burst_time;
-
-        printf("Completed %s at time %.2f ms\n", processes[i].process_name, current_time);
+    snprintf(cgroup_backend.path, sizeof(cgroup_backend.path), "%s/scheduler-%d", base, (int)getpid());
+    if (mkdir(cgroup_backend.path, 0755) != 0) {
+        fprintf(stderr, "Cannot create cgroup %s: %s\n", cgroup_backend.path, strerror(errno));
+        return -1;
     }
 
-    munmap(process_control, sizeof(ProcessControl));
+    cgroup_backend.enabled = 1;
+    cgroup_backend.owner = getpid();
+    atexit(cgroup_backend_cleanup);
+    return 0;
 }
-/* Implements Round Robin scheduling algorithm
- * Executes processes with time quantum-based preemption
+
+/* Moves a stopped child into its own leaf cgroup
+ * Everything the child forks later stays in the same leaf. On failure
+ * the process stays unattached and is preempted with signals
  */
-void round_robin(Process processes[], int n, int time_quantum_ms) {
-    printf("\nExecuting Round Robin Scheduling (Time Quantum: %d ms)...\n", time_quantum_ms);
-    event_count = 0;
+void cgroup_attach(Process* p) {
+    p->cgroup_attached = 0;
+    if (!cgroup_backend.enabled) return;
 
-    process_control = mmap(NULL, sizeof(ProcessControl), 
-                         PROT_READ | PROT_WRITE, 
-                         MAP_SHARED | MAP_ANONYMOUS, -1, 0);
-    if (process_control == MAP_FAILED) {
-        perror("mmap failed");
+    char leaf[CGROUP_PATH_LENGTH + 32], value[32];
+    cgroup_leaf_path(p->pid, leaf, sizeof(leaf));
+    snprintf(value, sizeof(value), "%d", (int)p->pid);
+
+    if (mkdir(leaf, 0755) != 0) {
+        fprintf(stderr, "Cannot create cgroup %s: %s\n", leaf, strerror(errno));
+        return;
+    }
+    if (cgroup_write(leaf, "cgroup.procs", value) != 0) {
+        fprintf(stderr, "Cannot attach %d to %s: %s\n", (int)p->pid, leaf, strerror(errno));
+        rmdir(leaf);
         return;
     }
+    p->cgroup_attached = 1;
+}
 
-    process_control->should_run = 1;
-    process_control->quantum = time_quantum_ms;
-    process_control->isPreemptive=1;
+/* Freezes or thaws the leaf cgroup of a process
+ * Freezing waits for cgroup.events to report the whole tree frozen and
+ * thaws again if it does not; returns -1 if the cgroup is not frozen
+ */
+int cgroup_set_frozen(pid_t pid, int frozen) {
+    char leaf[CGROUP_PATH_LENGTH + 32], events_path[PATH_MAX];
+    cgroup_leaf_path(pid, leaf, sizeof(leaf));
+    if (cgroup_write(leaf, "cgroup.freeze", frozen ? "1" : "0") != 0) return -1;
+    if (!frozen) return 0;
+
+    snprintf(events_path, sizeof(events_path), "%s/cgroup.events", leaf);
+    for (int waited = 0; waited < CGROUP_FREEZE_TIMEOUT_US; waited += 100) {
+        FILE* fp = fopen(events_path, "r");
+        if (fp == NULL) break;
+        char key[32];
+        int value, done = 0;
+        while (fscanf(fp, "%31s %d", key, &value) == 2) {
+            if (strcmp(key, "frozen") == 0) done = value;
+        }
+        fclose(fp);
+        if (done) return 0;
+        usleep(100);
+    }
 
-    double current_time = 0;
-    int completed = 0;
-    int* terminated = (int*)calloc(n, sizeof(int));
+    cgroup_write(leaf, "cgroup.freeze", "0");
+    return -1;
+}
 
-    double* first_execution_time = (double*)calloc(n, sizeof(double));
-    for (int i = 0; i < n; i++) {
-        first_execution_time[i] = -1;
-    }
+/* Reads the CPU time consumed by a process's leaf cgroup in ms
+ * Includes every descendant of the process; returns -1 if unavailable
+ */
+double cgroup_cpu_usage(const Process* p) {
+    if (!p->cgroup_attached) return -1;
 
-    struct sigaction sa;
-    sa.sa_handler = SIG_IGN;
-    sigemptyset(&sa.sa_mask);
-    sa.sa_flags = 0;
-    sigaction(SIGSTOP, &sa, NULL);
+    char leaf[CGROUP_PATH_LENGTH + 32], stat_path[PATH_MAX];
+    cgroup_leaf_path(p->pid, leaf, sizeof(leaf));
+    snprintf(stat_path, sizeof(stat_path), "%s/cpu.stat", leaf);
+
+    FILE* fp = fopen(stat_path, "r");
+    if (fp == NULL) return -1;
+
+    char key[32];
+    long long value;
+    double usage = -1;
+    while (fscanf(fp, "%31s %lld", key, &value) == 2) {
+        if (strcmp(key, "usage_usec") == 0) usage = value / 1000.0;
+    }
+    fclose(fp);
+    return usage;
+}
+
+/* Kills anything left in a finished process's leaf and removes it
+ */
+void cgroup_release(Process* p) {
+    if (!p->cgroup_attached) return;
+    p->cgroup_attached = 0;
+
+    char leaf[CGROUP_PATH_LENGTH + 32];
+    cgroup_leaf_path(p->pid, leaf, sizeof(leaf));
+    cgroup_write(leaf, "cgroup.kill", "1");
+    for (int attempt = 0; attempt < 100 && rmdir(leaf) != 0 && errno == EBUSY; attempt++) {
+        usleep(1000);
+    }
+}
+
+/* Resumes a dispatched process
+ * Thaws its cgroup when it has one; SIGCONT also resumes tasks that
+ * stopped themselves at a checkpoint
+ */
+void resume_process(const Process* p) {
+    if (p->cgroup_attached) {
+        cgroup_set_frozen(p->pid, 0);
+    }
+    kill(p->pid, SIGCONT);
+}
+
+/* Preempts a running process
+ * Returns 1 when the process is already off the CPU on return (cgroup
+ * freeze), or 0 when the stop will be reported later by waitpid()
+ */
+int preempt_process(const Process* p) {
+    if (p->cgroup_attached && cgroup_set_frozen(p->pid, 1) == 0) {
+        return 1;
+    }
+    kill(p->pid, SIGSTOP);
+    return 0;
+}
+/* Replaces the calling process with an external command
+ * Splits the command line on whitespace and runs it from command_dir,
+ * so relative paths resolve where the simulator was started; does not return
+ */
+void exec_command(const char* command) {
+    char buffer[MAX_COMMAND_LENGTH];
+    char* argv[MAX_COMMAND_ARGS + 1];
+    int argc = 0;
+
+    if (command_dir[0] != '\0' && chdir(command_dir) != 0) {
+        perror("Cannot change to command directory");
+        _exit(127);
+    }
+
+    snprintf(buffer, sizeof(buffer), "%s", command);
+    for (char* token = strtok(buffer, " \t"); token != NULL && argc < MAX_COMMAND_ARGS;
+         token = strtok(NULL, " \t")) {
+        argv[argc++] = token;
+    }
+    argv[argc] = NULL;
+
+    if (argc > 0) {
+        execvp(argv[0], argv);
+    }
+    perror("exec failed");
+    _exit(127);
+}
+/* Creates a new process using fork()
+ * The child stops itself until the scheduler dispatches it with SIGCONT,
+ * then runs its task or execs its external command. Returns -1 if the
+ * process could not be created, leaving its pid at 0
+ */
+
+int create_process(Process* p, ProcessControl* control, TraceRing* ring) {
+    pid_t pid = fork();
+
+    if (pid == 0) {
+        process_control = control;
+        current_trace_ring = ring;
+        raise(SIGSTOP);
+        /* External programs cannot emit trace records, so they stay untraced */
+        if (p->command[0] != '\0') {
+            exec_command(p->command);
+        }
+        trace_emit(TRACE_START);
+        p->task_function();
+        trace_emit(TRACE_EXIT);
+        exit(0);
+    } else if (pid > 0) {
+        int status;
+        waitpid(pid, &status, WUNTRACED);
+        p->pid = pid;
+        return 0;
+    }
+    perror("fork failed");
+    p->pid = 0;
+    return -1;
+}
+/* Ready queue and configuration shared by the dispatch loop and policies
+ * The queue is a circular FIFO of process indices
+ */
+typedef struct {
+    Process* processes;      // Processes being scheduled
+    int n;                   // Number of processes
+    int* ready;              // Ready queue storage
+    int ready_head;          // Index of the oldest ready entry
+    int ready_count;         // Number of ready processes
+} SchedulerState;
+
+/* Appends a process to the tail of the ready queue
+ */
+void ready_push(SchedulerState* st, int i) {
+    st->ready[(st->ready_head + st->ready_count++) % st->n] = i;
+}
+
+/* Returns the process at a position in the ready queue without removing it
+ */
+int ready_at(const SchedulerState* st, int slot) {
+    return st->ready[(st->ready_head + slot) % st->n];
+}
+
+/* Removes and returns the process at a position in the ready queue
+ * Keeps the remaining entries in arrival order
+ */
+int ready_take(SchedulerState* st, int slot) {
+    int i = ready_at(st, slot);
+    for (int k = slot; k > 0; k--) {
+        st->ready[(st->ready_head + k) % st->n] = st->ready[(st->ready_head + k - 1) % st->n];
+    }
+    st->ready_head = (st->ready_head + 1) % st->n;
+    st->ready_count--;
+    return i;
+}
+
+/* Scheduling policy callbacks driven by the dispatch loop
+ * pick_next is only called with a non-empty ready queue
+ */
+typedef struct {
+    const char* name;                                  // Name printed when the run starts
+    int preemptive;                                    // Preempt after quantum_ms of CPU
+    int (*pick_next)(SchedulerState* st);              // Removes and returns the next process to run
+    void (*on_arrival)(SchedulerState* st, int i);     // Process arrived and is ready
+    void (*on_preempt)(SchedulerState* st, int i);     // Process left the CPU and can run again
+    void (*on_exit)(SchedulerState* st, int i);        // Process exited
+} SchedulerPolicy;
+
+/* Policy callbacks shared by the built-in policies
+ */
+int pick_fifo(SchedulerState* st) {
+    return ready_take(st, 0);
+}
+
+int pick_shortest_burst(SchedulerState* st) {
+    int best = 0;
+    for (int k = 1; k < st->ready_count; k++) {
+        if (st->processes[ready_at(st, k)].burst_time < st->processes[ready_at(st, best)].burst_time) {
+            best = k;
+        }
+    }
+    return ready_take(st, best);
+}
+
+void enqueue_ready(SchedulerState* st, int i) {
+    ready_push(st, i);
+}
+
+void ignore_exit(SchedulerState* st, int i) {
+    (void)st;
+    (void)i;
+}
+
+const SchedulerPolicy fcfs_policy = {
+    "FCFS", 0, pick_fifo, enqueue_ready, enqueue_ready, ignore_exit
+};
+
+const SchedulerPolicy round_robin_policy = {
+    "Round Robin", 1, pick_fifo, enqueue_ready, enqueue_ready, ignore_exit
+};
+
+const SchedulerPolicy sjf_policy = {
+    "Shortest Job First", 0, pick_shortest_burst, enqueue_ready, enqueue_ready, ignore_exit
+};
+
+/* Sample policy that is not built in: preemptive shortest remaining
+ * time first, re-decided whenever the running process uses up its quantum.
+ * Run through run_scheduler(), so its callbacks are indirect calls
+ */
+int pick_shortest_remaining(SchedulerState* st) {
+    int best = 0;
+    for (int k = 1; k < st->ready_count; k++) {
+        if (st->processes[ready_at(st, k)].remaining_time < st->processes[ready_at(st, best)].remaining_time) {
+            best = k;
+        }
+    }
+    return ready_take(st, best);
+}
+
+const SchedulerPolicy srtf_policy = {
+    "Shortest Remaining Time First", 1, pick_shortest_remaining, enqueue_ready, enqueue_ready, ignore_exit
+};
+
+/* Publishes the dispatch loop's state to the metrics segment
+ * Called at most every METRICS_PUBLISH_INTERVAL_MS from the loop
+ */
+void publish_live_metrics(const SchedulerPolicy* policy, const SchedulerState* st,
+                          const ProcessState state[], const ProcessControl controls[],
+                          int active, double elapsed, int running,
+                          int blocked_count, int completed, double switches_per_sec) {
+    LiveMetrics* metrics = live_metrics;
+    if (metrics == NULL) return;
+
+    metrics_write_begin(metrics);
+    metrics->active = active;
+    snprintf(metrics->policy, sizeof(metrics->policy), "%s", policy->name);
+    metrics->elapsed = elapsed;
+    metrics->running = running;
+    metrics->ready_count = st->ready_count;
+    metrics->blocked_count = blocked_count;
+    metrics->completed = completed;
+    metrics->process_count = st->n;
+    metrics->switches = switch_stats.switches;
+    metrics->switches_per_sec = switches_per_sec;
+
+    int published = st->n < METRICS_MAX_PROCESSES ? st->n : METRICS_MAX_PROCESSES;
+    for (int i = 0; i < published; i++) {
+        ProcessMetrics* entry = &metrics->processes[i];
+        snprintf(entry->process_name, sizeof(entry->process_name), "%s", st->processes[i].process_name);
+        snprintf(entry->task_type, sizeof(entry->task_type), "%s", st->processes[i].task_type);
+        entry->state = state[i];
+        entry->progress = controls[i].progress;
+        entry->cpu_time = st->processes[i].burst_time - st->processes[i].remaining_time;
+    }
+    metrics_write_end(metrics);
+}
+/* Resets a quantile estimator to track the p-th quantile
+ */
+void quantile_init(QuantileEstimator* q, double p) {
+    memset(q, 0, sizeof(QuantileEstimator));
+    q->p = p;
+}
+/* Adds one observation to a P-square estimator
+ * Moves the three middle markers towards their desired positions with a
+ * parabolic step, falling back to a linear step when it would cross a neighbour
+ */
+void quantile_add(QuantileEstimator* q, double x) {
+    double* h = q->height;
+    double* pos = q->position;
+    double p = q->p;
+
+    if (q->count < QUANTILE_MARKERS) {
+        h[q->count++] = x;
+        if (q->count < QUANTILE_MARKERS) return;
+
+        for (int i = 1; i < QUANTILE_MARKERS; i++) {
+            for (int j = i; j > 0 && h[j - 1] > h[j]; j--) {
+                double t = h[j]; h[j] = h[j - 1]; h[j - 1] = t;
+            }
+        }
+        for (int i = 0; i < QUANTILE_MARKERS; i++) pos[i] = i + 1;
+        q->desired[0] = 1;
+        q->desired[1] = 1 + 2 * p;
+        q->desired[2] = 1 + 4 * p;
+        q->desired[3] = 3 + 2 * p;
+        q->desired[4] = 5;
+        return;
+    }
+
+    int k;
+    if (x < h[0]) {
+        h[0] = x;
+        k = 0;
+    } else if (x >= h[4]) {
+        h[4] = x;
+        k = 3;
+    } else {
+        for (k = 0; k < 3 && x >= h[k + 1]; k++);
+    }
+
+    for (int i = k + 1; i < QUANTILE_MARKERS; i++) pos[i]++;
+    q->desired[1] += p / 2;
+    q->desired[2] += p;
+    q->desired[3] += (1 + p) / 2;
+    q->desired[4] += 1;
+    q->count++;
+
+    for (int i = 1; i < QUANTILE_MARKERS - 1; i++) {
+        double d = q->desired[i] - pos[i];
+        if (!((d >= 1 && pos[i + 1] - pos[i] > 1) || (d <= -1 && pos[i - 1] - pos[i] < -1))) {
+            continue;
+        }
+        int step = d > 0 ? 1 : -1;
+        double parabolic = h[i] + step / (pos[i + 1] - pos[i - 1]) *
+            ((pos[i] - pos[i - 1] + step) * (h[i + 1] - h[i]) / (pos[i + 1] - pos[i]) +
+             (pos[i + 1] - pos[i] - step) * (h[i] - h[i - 1]) / (pos[i] - pos[i - 1]));
+        if (h[i - 1] < parabolic && parabolic < h[i + 1]) {
+            h[i] = parabolic;
+        } else {
+            h[i] += step * (h[i + step] - h[i]) / (pos[i + step] - pos[i]);
+        }
+        pos[i] += step;
+    }
+}
+/* Returns the current estimate of the quantile
+ * Exact while fewer than five observations have been seen
+ */
+double quantile_value(const QuantileEstimator* q) {
+    if (q->count == 0) return 0;
+    if (q->count >= QUANTILE_MARKERS) return q->height[2];
+
+    double sorted[QUANTILE_MARKERS];
+    int count = (int)q->count;
+    memcpy(sorted, q->height, count * sizeof(double));
+    for (int i = 1; i < count; i++) {
+        for (int j = i; j > 0 && sorted[j - 1] > sorted[j]; j--) {
+            double t = sorted[j]; sorted[j] = sorted[j - 1]; sorted[j - 1] = t;
+        }
+    }
+    return sorted[(int)(q->p * (count - 1) + 0.5)];
+}
+/* Resets a running summary
+ */
+void running_stats_init(RunningStats* rs) {
+    memset(rs, 0, sizeof(RunningStats));
+    quantile_init(&rs->p50, 0.50);
+    quantile_init(&rs->p95, 0.95);
+    quantile_init(&rs->p99, 0.99);
+}
+/* Adds one observation to a running summary
+ */
+void running_stats_add(RunningStats* rs, double x) {
+    rs->count++;
+    double delta = x - rs->mean;
+    rs->mean += delta / rs->count;
+    rs->m2 += delta * (x - rs->mean);
+    if (rs->count == 1 || x < rs->min) rs->min = x;
+    if (rs->count == 1 || x > rs->max) rs->max = x;
+    rs->sum += x;
+    rs->sum_squares += x * x;
+    quantile_add(&rs->p50, x);
+    quantile_add(&rs->p95, x);
+    quantile_add(&rs->p99, x);
+}
+/* Reads the p50, p95 and p99 estimates of a running summary
+ * The estimators run independently, so a later quantile can come out
+ * slightly below an earlier one; each is raised to at least the previous
+ */
+void running_stats_quantiles(const RunningStats* rs, double* p50, double* p95, double* p99) {
+    *p50 = quantile_value(&rs->p50);
+    *p95 = quantile_value(&rs->p95);
+    *p99 = quantile_value(&rs->p99);
+    if (*p95 < *p50) *p95 = *p50;
+    if (*p99 < *p95) *p99 = *p95;
+}
+/* Returns the sample standard deviation of a running summary
+ */
+double running_stats_stddev(const RunningStats* rs) {
+    return rs->count > 1 ? sqrt(rs->m2 / (rs->count - 1)) : 0;
+}
+/* Returns Jain's fairness index (sum x)^2 / (n * sum x^2)
+ * 1 when every observation is equal, 1/n when one dominates
+ */
+double running_stats_jain(const RunningStats* rs) {
+    if (rs->count == 0 || rs->sum_squares <= 0) return 0;
+    return rs->sum * rs->sum / (rs->count * rs->sum_squares);
+}
+/* Resets the run statistics at the start of a scheduling run
+ */
+void stream_stats_reset() {
+    running_stats_init(&stream_stats.turnaround);
+    running_stats_init(&stream_stats.waiting);
+    running_stats_init(&stream_stats.response);
+    running_stats_init(&stream_stats.slowdown);
+    running_stats_init(&stream_stats.service_rate);
+    running_stats_init(&stream_stats.slice);
+    stream_stats.negative_waits = 0;
+    stream_stats.next_snapshot = STATS_SNAPSHOT_INTERVAL_MS;
+}
+/* Accounts one dispatched slice, ended by preemption, blocking or exit
+ */
+void stream_stats_slice(double length) {
+    running_stats_add(&stream_stats.slice, length);
+}
+/* Finalizes the metrics of a process that has just completed
+ * and adds them to the run statistics. A negative waiting time means the
+ * process ran faster than its measured burst; it is kept as is and counted
+ */
+void stream_stats_complete(Process* p) {
+    p->turnaround_time = p->completion_time - p->arrival_time;
+    p->waiting_time = p->turnaround_time - p->burst_time;
+
+    running_stats_add(&stream_stats.turnaround, p->turnaround_time);
+    running_stats_add(&stream_stats.waiting, p->waiting_time);
+    running_stats_add(&stream_stats.response, p->response_time);
+    if (p->waiting_time < 0) stream_stats.negative_waits++;
+    if (p->turnaround_time > 0 && p->burst_time > 0) {
+        running_stats_add(&stream_stats.slowdown, p->turnaround_time / p->burst_time);
+        running_stats_add(&stream_stats.service_rate, p->burst_time / p->turnaround_time);
+    }
+}
+/* Prints a one-line snapshot of the run statistics
+ * Called as the run progresses; prints every STATS_SNAPSHOT_INTERVAL_MS of run time
+ */
+void stream_stats_snapshot(double current_time) {
+    if (current_time < stream_stats.next_snapshot) return;
+    stream_stats.next_snapshot = current_time + STATS_SNAPSHOT_INTERVAL_MS;
+
+    const RunningStats* t = &stream_stats.turnaround;
+    const RunningStats* s = &stream_stats.slice;
+    double p50, p95, p99;
+    running_stats_quantiles(t, &p50, &p95, &p99);
+    printf("[stats %.0f ms] completed %ld, turnaround mean %.2f sd %.2f p95 %.2f, "
+           "slices %ld mean %.2f ms\n",
+           current_time, t->count, t->mean, running_stats_stddev(t), p95,
+           s->count, s->mean);
+}
+/* Accounts the ready queue length for the time since the last tick
+ * Appends a series point every series_interval ms of run time
+ */
+void sample_queue(double current_time, int length, double elapsed) {
+    queue_stats.area += length * elapsed;
+    queue_stats.duration += elapsed;
+    if (length > queue_stats.max_length) queue_stats.max_length = length;
+
+    if (current_time < queue_stats.next_sample) return;
+
+    if (queue_stats.series_count == QUEUE_SERIES_POINTS) {
+        for (int k = 0; k < QUEUE_SERIES_POINTS / 2; k++) {
+            queue_stats.series[k] = queue_stats.series[2 * k] > queue_stats.series[2 * k + 1] ?
+                                    queue_stats.series[2 * k] : queue_stats.series[2 * k + 1];
+        }
+        queue_stats.series_count = QUEUE_SERIES_POINTS / 2;
+        queue_stats.series_interval *= 2;
+    }
+    queue_stats.series[queue_stats.series_count++] = length;
+    queue_stats.next_sample = current_time + queue_stats.series_interval;
+}
+/* Dispatch loop shared by every scheduling policy
+ * Admits arrivals, dispatches the process chosen by the policy, and ends
+ * the slice when the process exits, stops, blocks on I/O (in I/O-aware
+ * mode) or uses up its quantum. Always inlined so that each built-in
+ * policy gets a copy with its callbacks resolved at compile time.
+ * Returns -1 if the run could not be carried out
+ */
+static inline __attribute__((always_inline))
+int dispatch_loop(Process processes[], int n, const SchedulerPolicy* policy,
+                   int time_quantum_ms, int io_aware) {
+    reset_events(processes, n);
+    memset(&switch_stats, 0, sizeof(switch_stats));
+    memset(&io_stats, 0, sizeof(io_stats));
+    memset(&queue_stats, 0, sizeof(queue_stats));
+    queue_stats.series_interval = QUEUE_SAMPLE_INTERVAL_MS;
+    stream_stats_reset();
+
+    ProcessControl* controls = mmap(NULL, sizeof(ProcessControl) * n, 
+                                  PROT_READ | PROT_WRITE, 
+                                  MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (controls == MAP_FAILED) {
+        perror("mmap failed");
+        return -1;
+    }
+
+    trace_rings = create_trace_rings(n);
+    if (trace_rings == NULL) {
+        munmap(controls, sizeof(ProcessControl) * n);
+        return -1;
+    }
+    TraceAccumulator* traces = (TraceAccumulator*)calloc(n, sizeof(TraceAccumulator));
+    if (traces == NULL) {
+        perror("calloc failed");
+        destroy_trace_rings(trace_rings, n);
+        trace_rings = NULL;
+        munmap(controls, sizeof(ProcessControl) * n);
+        return -1;
+    }
+
+    for (int i = 0; i < n; i++) {
+        controls[i].should_run = 1;
+        controls[i].progress = 0;
+        controls[i].quantum = policy->preemptive ? time_quantum_ms : processes[i].burst_time;
+        controls[i].isPreemptive = policy->preemptive;
+        controls[i].io_aware = io_aware;
+        controls[i].service_time = processes[i].service_time;
+    }
+
+    SchedulerState st;
+    st.processes = processes;
+    st.n = n;
+    st.ready = (int*)malloc(n * sizeof(int));
+    st.ready_head = 0;
+    st.ready_count = 0;
+
+    ProcessState* state = (ProcessState*)calloc(n, sizeof(ProcessState));
+    double* blocked_since = (double*)calloc(n, sizeof(double));
+    int blocked_count = 0;
+    int completed = 0;
+
+    int running = -1;
+    int stop_sent = 0;
+    double slice_start = 0;
+    double dispatch_time = 0;
+    double dispatch_usage = -1;
+
+    double run_start = get_monotonic_time();
+    double last_tick = run_start;
+    double last_publish = run_start - METRICS_PUBLISH_INTERVAL_MS;
+    int last_switches = 0;
 
     while (completed < n) {
+        double now = get_monotonic_time();
+        double current_time = now - run_start;
+
+        if (live_metrics != NULL && now - last_publish >= METRICS_PUBLISH_INTERVAL_MS) {
+            double rate = (switch_stats.switches - last_switches) * 1000.0 / (now - last_publish);
+            publish_live_metrics(policy, &st, state, controls, 1, current_time, running,
+                                 blocked_count, completed, rate);
+            last_publish = now;
+            last_switches = switch_stats.switches;
+        }
+
+        if (blocked_count > 0) {
+            io_stats.io_active += now - last_tick;
+            if (running != -1) io_stats.io_overlap += now - last_tick;
+        }
+        sample_queue(current_time, st.ready_count, now - last_tick);
+        stream_stats_snapshot(current_time);
+        last_tick = now;
+
+        for (int i = 0; i < n; i++) {
+            if (state[i] != PROC_NEW || processes[i].arrival_time > current_time) continue;
+
+            if (create_process(&processes[i], &controls[i], &trace_rings[i]) != 0) {
+                /* Never signal pid 0, which is the scheduler's own process group */
+                printf("Could not start %s, skipping it\n", processes[i].process_name);
+                state[i] = PROC_DONE;
+                completed++;
+                continue;
+            }
+            cgroup_attach(&processes[i]);
+            processes[i].first_run = 1;
+            state[i] = PROC_READY;
+            policy->on_arrival(&st, i);
+        }
+
+        for (int i = 0; i < n; i++) {
+            if (state[i] != PROC_BLOCKED) continue;
+
+            drain_trace_ring(&trace_rings[i], &traces[i]);
+
+            int status;
+            pid_t result = waitpid(processes[i].pid, &status, WNOHANG | WUNTRACED);
+            if (result <= 0) continue;
+
+            io_stats.io_time += now - blocked_since[i];
+            blocked_count--;
+            if (WIFSTOPPED(status)) {
+                state[i] = PROC_READY;
+                policy->on_preempt(&st, i);
+            } else {
+                state[i] = PROC_DONE;
+                processes[i].completion_time = current_time;
+                stream_stats_complete(&processes[i]);
+                completed++;
+                cgroup_release(&processes[i]);
+                policy->on_exit(&st, i);
+            }
+        }
+
+        if (running == -1 && st.ready_count > 0) {
+            running = policy->pick_next(&st);
+
+            state[running] = PROC_RUNNING;
+            slice_start = current_time;
+            dispatch_time = now;
+            stop_sent = 0;
+            controls[running].resume_time = 0;
+            trace_begin_slice(&traces[running], dispatch_time);
+
+            printf("%s %s at time %.2f ms\n", processes[running].first_run ? "Starting" : "Resuming",
+                   processes[running].process_name, current_time);
+            if (processes[running].first_run) {
+                processes[running].first_run = 0;
+                processes[running].response_time = current_time - processes[running].arrival_time;
+            }
+
+            dispatch_usage = cgroup_cpu_usage(&processes[running]);
+            resume_process(&processes[running]);
+            switch_stats.switches++;
+        }
+
+        if (running != -1) {
+            int i = running;
+            ProcessState next_state = PROC_RUNNING;
+
+            drain_trace_ring(&trace_rings[i], &traces[i]);
+
+            int status;
+            pid_t result = waitpid(processes[i].pid, &status, WNOHANG | WUNTRACED);
+            if (result > 0 && WIFSTOPPED(status)) {
+                next_state = PROC_READY;
+            } else if (result > 0) {
+                next_state = PROC_DONE;
+            } else if (io_aware && traces[i].in_io) {
+                next_state = PROC_BLOCKED;
+            } else if (policy->preemptive && !stop_sent && now - dispatch_time >= time_quantum_ms) {
+                if (preempt_process(&processes[i])) {
+                    next_state = PROC_READY;
+                }
+                stop_sent = 1;
+            }
+
+            if (next_state != PROC_RUNNING) {
+                if (controls[i].resume_time > 0) {
+                    switch_stats.latency_samples++;
+                    switch_stats.total_latency += controls[i].resume_time - dispatch_time;
+                }
+                trace_end_slice(&trace_rings[i], &traces[i], now);
+                int traced = processes[i].command[0] == '\0';
+                if (dispatch_usage >= 0) {
+                    double usage = cgroup_cpu_usage(&processes[i]);
+                    if (usage >= 0) {
+                        traces[i].cpu_time = usage - dispatch_usage;
+                        traced = 1;
+                    }
+                }
+                processes[i].remaining_time -= now - dispatch_time;
+                stream_stats_slice(now - dispatch_time);
+                record_event(&processes[i], slice_start, current_time,
+                             traced ? &traces[i] : NULL);
+                log_decision(i, next_state == PROC_DONE ? SLICE_COMPLETED :
+                                next_state == PROC_BLOCKED ? SLICE_BLOCKED : SLICE_PREEMPTED,
+                             slice_start, current_time);
+
+                state[i] = next_state;
+                running = -1;
+                if (next_state == PROC_READY) {
+                    policy->on_preempt(&st, i);
+                } else if (next_state == PROC_BLOCKED) {
+                    blocked_since[i] = now;
+                    blocked_count++;
+                } else {
+                    processes[i].completion_time = current_time;
+                    stream_stats_complete(&processes[i]);
+                    printf("Completed %s at time %.2f ms\n", processes[i].process_name, current_time);
+                    completed++;
+                    cgroup_release(&processes[i]);
+                    policy->on_exit(&st, i);
+                }
+                continue;
+            }
+        }
+
+        usleep(IO_POLL_INTERVAL_US);
+    }
+
+    publish_live_metrics(policy, &st, state, controls, 0, get_monotonic_time() - run_start, -1,
+                         blocked_count, completed, 0);
+
+    free(st.ready);
+    free(blocked_since);
+    free(state);
+    free(traces);
+    destroy_trace_rings(trace_rings, n);
+    trace_rings = NULL;
+    munmap(controls, sizeof(ProcessControl) * n);
+    return 0;
+}
+/* Runs an arbitrary scheduling policy
+ * Entry point for policies that are not built in; callbacks are
+ * called through the policy's function pointers
+ */
+int run_scheduler(Process processes[], int n, const SchedulerPolicy* policy,
+                  int time_quantum_ms, int io_aware) {
+    printf("\nExecuting %s%s Scheduling...\n", io_aware ? "I/O-aware " : "", policy->name);
+    return dispatch_loop(processes, n, policy, time_quantum_ms, io_aware);
+}
+/* Implements First-Come-First-Serve scheduling algorithm
+ * Executes processes in order of arrival
+ */
+int fcfs(Process processes[], int n, int io_aware) {
+    printf("\nExecuting %sFCFS Scheduling...\n", io_aware ? "I/O-aware " : "");
+    return dispatch_loop(processes, n, &fcfs_policy, 0, io_aware);
+}
+/* Implements Round Robin scheduling algorithm
+ * Executes processes with time quantum-based preemption
+ */
+int round_robin(Process processes[], int n, int time_quantum_ms, int io_aware) {
+    printf("\nExecuting %sRound Robin Scheduling (Time Quantum: %d ms)...\n",
+           io_aware ? "I/O-aware " : "", time_quantum_ms);
+    return dispatch_loop(processes, n, &round_robin_policy, time_quantum_ms, io_aware);
+}
+/* Implements Shortest Job First scheduling algorithm
+ * Executes processes ordered by burst time
+ */
+int sjf(Process processes[], int n, int io_aware) {
+    printf("\nExecuting %sShortest Job First Scheduling...\n", io_aware ? "I/O-aware " : "");
+    return dispatch_loop(processes, n, &sjf_policy, 0, io_aware);
+}
+/* Entry point for a coroutine task
+ * Runs the task function and marks the coroutine finished,
+ * after which uc_link returns control to the scheduler
+ */
+void coroutine_entry() {
+    trace_emit(TRACE_START);
+    current_coroutine->task_function();
+    trace_emit(TRACE_EXIT);
+    current_coroutine->finished = 1;
+}
+/* Implements Round Robin scheduling with in-process coroutines
+ * Tasks yield at their quantum checkpoints via swapcontext, which
+ * allows quanta in the microsecond range without kernel round trips.
+ * Returns -1 if the run could not be carried out
+ */
+int round_robin_coroutine(Process processes[], int n, int time_quantum_us) {
+    for (int i = 0; i < n; i++) {
+        if (processes[i].command[0] != '\0') {
+            printf("\n%s runs an external command and cannot run as a coroutine.\n",
+                   processes[i].process_name);
+            return -1;
+        }
+    }
+
+    printf("\nExecuting Round Robin Scheduling with coroutines (Time Quantum: %d us)...\n", time_quantum_us);
+    reset_events(processes, n);
+    memset(&switch_stats, 0, sizeof(switch_stats));
+    stream_stats_reset();
+
+    process_control = mmap(NULL, sizeof(ProcessControl), 
+                         PROT_READ | PROT_WRITE, 
+                         MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (process_control == MAP_FAILED) {
+        perror("mmap failed");
+        return -1;
+    }
+
+    trace_rings = create_trace_rings(n);
+    if (trace_rings == NULL) {
+        munmap(process_control, sizeof(ProcessControl));
+        return -1;
+    }
+    TraceAccumulator* traces = (TraceAccumulator*)calloc(n, sizeof(TraceAccumulator));
+
+    process_control->should_run = 1;
+    process_control->quantum = time_quantum_us / 1000.0;
+    process_control->isPreemptive = 1;
+
+    double current_time = 0;
+    int completed = 0;
+    int failed = 0;
+    Coroutine* coroutines = (Coroutine*)calloc(n, sizeof(Coroutine));
+    if (traces == NULL || coroutines == NULL) {
+        perror("calloc failed");
+        failed = 1;
+    }
+
+    while (!failed && completed < n) {
         int work_done = 0;
 
-        for (int i = 0; i < n; i++) {
+        for (int i = 0; i < n; i++) {
+
+            if (coroutines[i].finished || processes[i].arrival_time > current_time) {
+                continue;
+            }
+
+            work_done = 1;
+
+            if (coroutines[i].stack == NULL) {
+                coroutines[i].stack = malloc(COROUTINE_STACK_SIZE);
+                if (coroutines[i].stack == NULL) {
+                    perror("malloc failed");
+                    failed = 1;
+                    break;
+                }
+                coroutines[i].task_function = processes[i].task_function;
+                getcontext(&coroutines[i].context);
+                coroutines[i].context.uc_stack.ss_sp = coroutines[i].stack;
+                coroutines[i].context.uc_stack.ss_size = COROUTINE_STACK_SIZE;
+                coroutines[i].context.uc_link = &scheduler_context;
+                makecontext(&coroutines[i].context, coroutine_entry, 0);
+
+                processes[i].first_run = 0;
+                processes[i].response_time = current_time - processes[i].arrival_time;
+                processes[i].pid = getpid();
+                process_control->progress = 0;
+            }
+
+            double start_time = current_time;
+            double dispatch_time = get_monotonic_time();
+            process_control->resume_time = 0;
+            trace_begin_slice(&traces[i], dispatch_time);
+
+            current_coroutine = &coroutines[i];
+            current_trace_ring = &trace_rings[i];
+            swapcontext(&scheduler_context, &coroutines[i].context);
+            current_trace_ring = NULL;
+            current_coroutine = NULL;
+
+            double end_time = get_monotonic_time();
+            double elapsed = end_time - dispatch_time;
+            switch_stats.switches++;
+            if (process_control->resume_time > 0) {
+                switch_stats.latency_samples++;
+                switch_stats.total_latency += process_control->resume_time - dispatch_time;
+            }
+
+            current_time += elapsed;
+            processes[i].remaining_time -= elapsed;
+            stream_stats_slice(elapsed);
+
+            trace_end_slice(&trace_rings[i], &traces[i], end_time);
+            record_event(&processes[i], start_time, current_time, &traces[i]);
+            log_decision(i, coroutines[i].finished ? SLICE_COMPLETED : SLICE_PREEMPTED,
+                         start_time, current_time);
+
+            if (coroutines[i].finished) {
+                free(coroutines[i].stack);
+                coroutines[i].stack = NULL;
+                processes[i].remaining_time = 0;
+                processes[i].completion_time = current_time;
+                stream_stats_complete(&processes[i]);
+                completed++;
+            }
+            stream_stats_snapshot(current_time);
+        }
+
+        if (!failed && !work_done) {
+            double next_arrival = __DBL_MAX__;
+            for (int i = 0; i < n; i++) {
+                if (!coroutines[i].finished && processes[i].arrival_time > current_time) {
+                    next_arrival = (next_arrival < processes[i].arrival_time) ? 
+                                  next_arrival : processes[i].arrival_time;
+                }
+            }
+            if (next_arrival != __DBL_MAX__) {
+                current_time = next_arrival;
+            }
+        }
+    }
+
+    /* Stacks of coroutines left unfinished by a failed run are never resumed */
+    for (int i = 0; coroutines != NULL && i < n; i++) {
+        free(coroutines[i].stack);
+    }
+    free(coroutines);
+    free(traces);
+    destroy_trace_rings(trace_rings, n);
+    trace_rings = NULL;
+    munmap(process_control, sizeof(ProcessControl));
+    return failed ? -1 : 0;
+}
+/* Runs one recorded slice of a process during replay
+ * Preempts the process after slice_ms if the recorded slice was preempted;
+ * otherwise lets it run past quantum checkpoints until it exits or, for a
+ * blocked slice, until it blocks on I/O. Returns the SliceOutcome actually observed and sets
+ * in_io if the process is still doing that I/O in the background
+ */
+SliceOutcome run_replay_slice(Process* p, TraceRing* ring, TraceAccumulator* trace,
+                              double slice_ms, SliceOutcome expected, double* elapsed_ms,
+                              int* in_io) {
+    double dispatch_time = get_monotonic_time();
+    process_control->resume_time = 0;
+    trace_begin_slice(trace, dispatch_time);
+
+    resume_process(p);
+    switch_stats.switches++;
+
+    int outcome = -1;
+    int stop_sent = 0;
+    int resumed_again = 0;
+    *in_io = 0;
+    while (outcome < 0) {
+        double elapsed = get_monotonic_time() - dispatch_time;
+
+        if (expected == SLICE_PREEMPTED && !stop_sent && elapsed >= slice_ms) {
+            stop_sent = 1;
+            if (preempt_process(p)) {
+                outcome = SLICE_PREEMPTED;
+                break;
+            }
+        }
+
+        int status;
+        pid_t result = waitpid(p->pid, &status, WNOHANG | WUNTRACED);
+        if (result > 0) {
+            if (WIFSTOPPED(status)) {
+                drain_trace_ring(ring, trace);
+                if (expected == SLICE_BLOCKED && (trace->in_io || trace->io_time > 0)) {
+                    /* Blocked, finished the I/O and stopped before the next poll */
+                    outcome = SLICE_BLOCKED;
+                    break;
+                }
+                if (expected == SLICE_PREEMPTED) {
+                    outcome = SLICE_PREEMPTED;
+                    break;
+                }
+                kill(p->pid, SIGCONT);
+                resumed_again = 1;
+            } else if (WIFEXITED(status) || WIFSIGNALED(status)) {
+                outcome = SLICE_COMPLETED;
+                break;
+            }
+        }
+
+        drain_trace_ring(ring, trace);
+        if (expected == SLICE_BLOCKED && trace->in_io) {
+            outcome = SLICE_BLOCKED;
+            *in_io = 1;
+            break;
+        }
+        usleep(1000);
+    }
+
+    double end_time = get_monotonic_time();
+    if (process_control->resume_time > 0 && !resumed_again) {
+        switch_stats.latency_samples++;
+        switch_stats.total_latency += process_control->resume_time - dispatch_time;
+    }
+    trace_end_slice(ring, trace, end_time);
+
+    *elapsed_ms = end_time - dispatch_time;
+    return outcome;
+}
+/* Re-executes a recorded sequence of scheduling decisions
+ * Dispatches the same process for the same slice length as the recording,
+ * and counts decisions whose outcome differs from the recorded one. In
+ * I/O-aware mode a process that blocked finishes its I/O in the background
+ * and is waited for before its next slice
+ */
+int replay_schedule(Process processes[], int n, int preemptive, int io_aware,
+                    ScheduleLogDecision decisions[], int decision_count,
+                    double* slice_deviation) {
+    printf("\nReplaying %d recorded scheduling decisions%s...\n", decision_count,
+           io_aware ? " with blocking I/O" : "");
+    reset_events(processes, n);
+    memset(&switch_stats, 0, sizeof(switch_stats));
+    stream_stats_reset();
+    *slice_deviation = 0;
+
+    process_control = mmap(NULL, sizeof(ProcessControl), 
+                         PROT_READ | PROT_WRITE, 
+                         MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (process_control == MAP_FAILED) {
+        perror("mmap failed");
+        return -1;
+    }
+
+    trace_rings = create_trace_rings(n);
+    if (trace_rings == NULL) {
+        munmap(process_control, sizeof(ProcessControl));
+        return -1;
+    }
+    TraceAccumulator* traces = (TraceAccumulator*)calloc(n, sizeof(TraceAccumulator));
+
+    process_control->should_run = 1;
+    process_control->isPreemptive = preemptive;
+    process_control->io_aware = io_aware;
+
+    double current_time = 0;
+    int divergences = 0;
+    int* terminated = (int*)calloc(n, sizeof(int));
+    int* blocked = (int*)calloc(n, sizeof(int));
+
+    for (int d = 0; d < decision_count + n; d++) {
+        int i;
+        double slice_ms;
+        SliceOutcome expected;
+
+        if (d < decision_count) {
+            i = decisions[d].process_index;
+            if (i < 0 || i >= n || terminated[i]) {
+                divergences++;
+                continue;
+            }
+            slice_ms = decisions[d].end_time - decisions[d].start_time;
+            expected = (SliceOutcome)decisions[d].outcome;
+            if (decisions[d].start_time > current_time) {
+                current_time = decisions[d].start_time;
+            }
+        } else {
+            /* Processes the recording finished earlier than the replay */
+            i = d - decision_count;
+            if (terminated[i]) continue;
+            slice_ms = 0;
+            expected = SLICE_COMPLETED;
+        }
+
+        if (blocked[i]) {
+            /* The recording dispatched it again only once its I/O was done */
+            int status;
+            blocked[i] = 0;
+            waitpid(processes[i].pid, &status, WUNTRACED);
+            drain_trace_ring(&trace_rings[i], &traces[i]);
+            if (!WIFSTOPPED(status)) {
+                terminated[i] = 1;
+                processes[i].remaining_time = 0;
+                processes[i].completion_time = current_time;
+                stream_stats_complete(&processes[i]);
+                cgroup_release(&processes[i]);
+                if (d < decision_count) divergences++;
+                continue;
+            }
+        }
+        if (d >= decision_count) divergences++;
+
+        process_control->quantum = slice_ms;
+
+        if (processes[i].pid == 0) {
+            processes[i].first_run = 0;
+            processes[i].response_time = current_time - processes[i].arrival_time;
+            process_control->progress = 0;
+
+            if (create_process(&processes[i], process_control, &trace_rings[i]) != 0) {
+                printf("Could not start %s, skipping it\n", processes[i].process_name);
+                terminated[i] = 1;
+                if (d < decision_count) divergences++;
+                continue;
+            }
+            cgroup_attach(&processes[i]);
+        }
+
+        double start_time = current_time;
+        double elapsed;
+        SliceOutcome outcome = run_replay_slice(&processes[i], &trace_rings[i], &traces[i],
+                                                slice_ms, expected, &elapsed, &blocked[i]);
+
+        current_time += elapsed;
+        processes[i].remaining_time -= elapsed;
+        stream_stats_slice(elapsed);
+        record_event(&processes[i], start_time, current_time,
+                     processes[i].command[0] == '\0' ? &traces[i] : NULL);
+
+        if (d < decision_count) {
+            double deviation = elapsed - slice_ms;
+            *slice_deviation += deviation < 0 ? -deviation : deviation;
+            if (outcome != expected) divergences++;
+        }
+
+        if (outcome == SLICE_COMPLETED) {
+            terminated[i] = 1;
+            processes[i].remaining_time = 0;
+            processes[i].completion_time = current_time;
+            stream_stats_complete(&processes[i]);
+            cgroup_release(&processes[i]);
+        }
+        stream_stats_snapshot(current_time);
+    }
+
+    if (decision_count > 0) {
+        *slice_deviation /= decision_count;
+    }
+
+    free(blocked);
+    free(terminated);
+    free(traces);
+    destroy_trace_rings(trace_rings, n);
+    trace_rings = NULL;
+    munmap(process_control, sizeof(ProcessControl));
+    return divergences;
+}
+/* Prints CPU utilization and I/O overlap for the last run
+ * Utilization is measured against the time of the last completion
+ */
+void print_utilization(Process processes[], int n) {
+    if (run_totals.slices == 0) return;
+
+    double makespan = run_totals.last_end;
+    for (int i = 0; i < n; i++) {
+        if (processes[i].completion_time > makespan) makespan = processes[i].completion_time;
+    }
+    if (makespan <= 0) return;
+
+    printf("\nUtilization:\n");
+    printf("CPU Dispatched: %.1f%% of %.2f ms\n", run_totals.dispatched * 100.0 / makespan, makespan);
+    if (run_totals.traced_slices > 0) {
+        printf("CPU Utilization (on-CPU): %.1f%%\n", run_totals.on_cpu * 100.0 / makespan);
+    }
+    if (io_stats.io_time > 0) {
+        printf("I/O Blocked Time: %.2f ms\n", io_stats.io_time);
+        printf("I/O Overlapped with Computation: %.1f%% of %.2f ms with I/O in flight\n",
+               io_stats.io_active > 0 ? io_stats.io_overlap * 100.0 / io_stats.io_active : 0,
+               io_stats.io_active);
+    }
+}
+/* Prints per-process time reported by the tasks' trace rings
+ * Compares scheduled time with the on-CPU and I/O time the tasks observed
+ */
+void print_trace_summary(Process processes[], int n) {
+    if (run_totals.traced_slices == 0) return;
+
+    printf("\nTraced Execution:\n");
+    printf("%-8s %-8s %-14s %-14s %-14s\n", "Process", "Slices", "Scheduled", "On-CPU", "I/O");
+
+    for (int i = 0; i < n; i++) {
+        if (processes[i].traced_slices == 0) {
+            printf("%-8s %-8d %-14.2f %-14s %-14s\n", processes[i].process_name,
+                   processes[i].slices, processes[i].scheduled_time, "-", "-");
+            continue;
+        }
+        printf("%-8s %-8d %-14.2f %-14.2f %-14.2f\n", processes[i].process_name,
+               processes[i].slices, processes[i].scheduled_time,
+               processes[i].cpu_time, processes[i].io_time);
+    }
+
+    if (trace_dropped > 0) {
+        printf("Dropped trace records: %u\n", trace_dropped);
+    }
+}
+/* Prints one row of the summary statistics table
+ */
+void print_running_stats(const char* name, const RunningStats* rs) {
+    if (rs->count == 0) return;
+    double p50, p95, p99;
+    running_stats_quantiles(rs, &p50, &p95, &p99);
+    printf("%-12s %-7ld %-10.2f %-10.2f %-10.2f %-10.2f %-10.2f %-10.2f %-10.2f\n",
+           name, rs->count, rs->mean, running_stats_stddev(rs), rs->min,
+           p50, p95, p99, rs->max);
+}
+/* Prints the final report of the run statistics
+ * Quantiles are P-square estimates, exact for fewer than five observations
+ */
+void print_stream_stats() {
+    printf("\nSummary Statistics:\n");
+    printf("%-12s %-7s %-10s %-10s %-10s %-10s %-10s %-10s %-10s\n",
+           "Metric", "Count", "Mean", "StdDev", "Min", "p50", "p95", "p99", "Max");
+    print_running_stats("Turnaround", &stream_stats.turnaround);
+    print_running_stats("Waiting", &stream_stats.waiting);
+    print_running_stats("Response", &stream_stats.response);
+    print_running_stats("Slowdown", &stream_stats.slowdown);
+    print_running_stats("Slice", &stream_stats.slice);
+
+    if (stream_stats.service_rate.count > 0) {
+        printf("Jain's Fairness Index (burst/turnaround): %.3f\n",
+               running_stats_jain(&stream_stats.service_rate));
+    }
+    if (stream_stats.negative_waits > 0) {
+        printf("Measurement error: %ld of %ld processes finished before their measured burst "
+               "(waiting time down to %.2f ms)\n",
+               stream_stats.negative_waits, stream_stats.waiting.count, stream_stats.waiting.min);
+    }
+}
+/* Prints detailed statistics for all processes
+ * Shows timing metrics and generates Gantt chart
+ */
+void print_stats(Process processes[], int n) {
+    printf("\nProcess Statistics:\n");
+    printf("%-8s %-8s %-12s %-12s %-12s %-12s %-12s %-12s\n",
+           "Process", "PID", "Task", "Arrival", "Burst", "Completion", "Turnaround", "Waiting");
+    printf("---------------------------------------------------------------------------------------\n");
+
+    for (int i = 0; i < n; i++) {
+        printf("%-8s %-8d %-12s %-12d %-12.2f %-12.2f %-12.2f %-12.2f\n",
+               processes[i].process_name,
+               processes[i].pid,
+               processes[i].task_type,
+               processes[i].arrival_time,
+               processes[i].burst_time,
+               processes[i].completion_time,
+               processes[i].turnaround_time,
+               processes[i].waiting_time);
+    }
+
+    print_stream_stats();
 
-            if (terminated[i] || processes[i].arrival_time > current_time) {
-                continue;
-            }
+    if (switch_stats.switches > 0) {
+        printf("\nContext Switch Overhead:\n");
+        printf("Context Switches: %d\n", switch_stats.switches);
+        if (switch_stats.latency_samples > 0) {
+            printf("Average Dispatch Latency: %.3f us (%d samples)\n",
+                   switch_stats.total_latency * 1000.0 / switch_stats.latency_samples,
+                   switch_stats.latency_samples);
+        }
+    }
 
-            if (processes[i].remaining_time <= 0) {
-                if (!terminated[i]) {
-                    terminated[i] = 1;
-                    completed++;
-                    processes[i].completion_time = current_time;
-                }
-                continue;
-            }
+    print_utilization(processes, n);
+    print_trace_summary(processes, n);
+    print_gantt_chart();
+}
+/* Reads a binary log written by begin_schedule_log() and finish_schedule_log()
+ * Allocates the process and decision records, which the caller frees
+ */
+int read_schedule_log(const char* path, ScheduleLogHeader* header,
+                      ScheduleLogProcess** processes, ScheduleLogDecision** decisions) {
+    FILE* fp = fopen(path, "rb");
+    if (fp == NULL) {
+        perror("Cannot open schedule log");
+        return -1;
+    }
 
-            work_done = 1;
+    if (fread(header, sizeof(*header), 1, fp) != 1 ||
+        header->magic != SCHEDULE_LOG_MAGIC ||
+        header->version != SCHEDULE_LOG_VERSION ||
+        header->process_count <= 0 || header->process_count > MAX_PROCESSES ||
+        header->decision_count < 0) {
+        fprintf(stderr, "%s is not a valid schedule log\n", path);
+        fclose(fp);
+        return -1;
+    }
 
-            if (first_execution_time[i] == -1) {
-                first_execution_time[i] = current_time;
-            }
+    *processes = (ScheduleLogProcess*)calloc(header->process_count, sizeof(ScheduleLogProcess));
+    *decisions = (ScheduleLogDecision*)calloc(header->decision_count + 1, sizeof(ScheduleLogDecision));
 
-            if (processes[i].pid == 0) {
-                if (processes[i].first_run) {
-                    processes[i].first_run = 0;
-                    process_control->progress = 0;
-                }
+    if (fread(*processes, sizeof(ScheduleLogProcess), header->process_count, fp) !=
+            (size_t)header->process_count ||
+        fread(*decisions, sizeof(ScheduleLogDecision), header->decision_count, fp) !=
+            (size_t)header->decision_count) {
+        fprintf(stderr, "%s is truncated\n", path);
+        free(*processes);
+        free(*decisions);
+        fclose(fp);
+        return -1;
+    }
 
-                pid_t pid = fork();
-                if (pid == 0) {
-                    struct sigaction child_sa;
-                    child_sa.sa_handler = SIG_DFL;
-                    sigemptyset(&child_sa.sa_mask);
-                    child_sa.sa_flags = 0;
-                    sigaction(SIGSTOP, &child_sa, NULL);
+    fclose(fp);
+    return 0;
+}
+/* Replays a recorded run and prints how the outcome differs
+ * Uses the recorded burst times and seed instead of remeasuring
+ */
+int replay_from_log(const char* path) {
+    ScheduleLogHeader header;
+    ScheduleLogProcess* recorded;
+    ScheduleLogDecision* decisions;
 
-                    processes[i].task_function();
-                    exit(0);
-                } else if (pid > 0) {
-                    processes[i].pid = pid;
-                }
-            }
+    if (read_schedule_log(path, &header, &recorded, &decisions) != 0) {
+        return 1;
+    }
 
-            double exec_time = (processes[i].remaining_time > time_quantum_ms) ? 
-                              time_quantum_ms : processes[i].remaining_time;
+    int n = header.process_count;
+    simulation_seed = header.seed;
 
-            printf("Executing %s for %.2f ms at %.2f (Progress: %d)\n", 
-                   processes[i].process_name, exec_time, current_time, 
-                   process_control->progress);
+    int io_aware = (header.flags & SCHEDULE_LOG_IO_AWARE) != 0;
+    printf("Loaded %s%s run with %d processes (seed %u)\n", io_aware ? "I/O-aware " : "",
+           algorithm_name(header.algorithm), n, header.seed);
 
-            double start_time = current_time;
-            struct timespec start, now;
-            clock_gettime(CLOCK_MONOTONIC, &start);
+    if ((header.flags & SCHEDULE_LOG_CGROUP) && !cgroup_backend.enabled &&
+        cgroup_backend_init() != 0) {
+        fprintf(stderr, "Recorded with --cgroup, but the cgroup v2 backend is unavailable;"
+                " replaying with signals\n");
+    }
 
-            kill(processes[i].pid, SIGCONT);
+    Process processes[MAX_PROCESSES];
+    for (int i = 0; i < n; i++) {
+        memset(&processes[i], 0, sizeof(Process));
+        recorded[i].process_name[sizeof(recorded[i].process_name) - 1] = '\0';
+        recorded[i].task_type[sizeof(recorded[i].task_type) - 1] = '\0';
+        recorded[i].command[sizeof(recorded[i].command) - 1] = '\0';
+        strcpy(processes[i].process_name, recorded[i].process_name);
+        strcpy(processes[i].task_type, recorded[i].task_type);
+        strcpy(processes[i].command, recorded[i].command);
+        processes[i].task_function = lookup_task_function(recorded[i].task_type);
+        if (processes[i].task_function == NULL && processes[i].command[0] == '\0') {
+            fprintf(stderr, "Unknown task type %s in %s\n", recorded[i].task_type, path);
+            free(recorded);
+            free(decisions);
+            return 1;
+        }
+        processes[i].arrival_time = recorded[i].arrival_time;
+        processes[i].burst_time = recorded[i].burst_time;
+        processes[i].remaining_time = recorded[i].burst_time;
+        processes[i].first_run = 1;
+    }
 
-            int process_stopped = 0;
-            while (!process_stopped) {
-                clock_gettime(CLOCK_MONOTONIC, &now);
-                double elapsed = (now.tv_sec - start.tv_sec) * 1000.0 + 
-                               (now.tv_nsec - start.tv_nsec) / 1000000.0;
+    int preemptive = header.algorithm == 2 || header.algorithm == 4 || header.algorithm == 6;
+    double slice_deviation;
+    int divergences = replay_schedule(processes, n, preemptive, io_aware,
+                                      decisions, header.decision_count, &slice_deviation);
+    if (divergences < 0) {
+        free(recorded);
+        free(decisions);
+        return 1;
+    }
 
-                if (elapsed >= exec_time) {
-                    kill(processes[i].pid, SIGSTOP);
-                    process_stopped = 1;
-                }
+    print_stats(processes, n);
 
-                int status;
-                pid_t result = waitpid(processes[i].pid, &status, WNOHANG | WUNTRACED);
-                if (result > 0) {
-                    if (WIFSTOPPED(status)) {
-                        process_stopped = 1;
-                        elapsed = elapsed > exec_time ? exec_time : elapsed;
-                    } else if (WIFEXITED(status)) {
-                        process_stopped = 1;
-                        processes[i].remaining_time = 0;
-                        terminated[i] = 1;
-                        completed++;
-                        processes[i].completion_time = current_time + elapsed;
-                    }
-                }
+    printf("\nReplay Diff:\n");
+    printf("%-8s %-14s %-14s %-14s %-14s\n",
+           "Process", "Recorded", "Replayed", "Completion", "Turnaround");
+    printf("%-8s %-14s %-14s %-14s %-14s\n",
+           "", "Completion", "Completion", "Delta", "Delta");
+    for (int i = 0; i < n; i++) {
+        printf("%-8s %-14.2f %-14.2f %-+14.2f %-+14.2f\n",
+               processes[i].process_name,
+               recorded[i].completion_time,
+               processes[i].completion_time,
+               processes[i].completion_time - recorded[i].completion_time,
+               processes[i].turnaround_time - recorded[i].turnaround_time);
+    }
+    printf("\nDecisions Replayed: %d\n", header.decision_count);
+    printf("Outcome Divergences: %d\n", divergences);
+    printf("Mean Slice Deviation: %.3f ms\n", slice_deviation);
 
-                if (!process_stopped) {
-                    usleep(1000);
-                }
-            }
+    free(recorded);
+    free(decisions);
+    return 0;
+}
+/* Structure holding the outcome of one round robin run in a sweep
+ * Written by the worker process into shared memory
+ */
+typedef struct {
+    int quantum;               // Time quantum of the run (ms)
+    int valid;                 // Set once the worker has finished
+    double avg_turnaround;     // Average turnaround time (ms)
+    double avg_waiting;        // Average waiting time (ms)
+    double avg_response;       // Average response time (ms)
+    int switches;              // Number of dispatches
+    double switch_overhead;    // Total measured dispatch latency (ms)
+} QuantumResult;
+
+/* Objectives that the quantum sweep can optimize
+ */
+typedef enum {
+    OBJECTIVE_TURNAROUND = 1,
+    OBJECTIVE_RESPONSE,
+    OBJECTIVE_WAITING
+} SweepObjective;
+
+/* Returns the value of a sweep metric for one run
+ * Metric ids follow SweepObjective, with 0 selecting switch overhead
+ */
+double sweep_metric(const QuantumResult* result, int metric) {
+    switch (metric) {
+        case OBJECTIVE_TURNAROUND: return result->avg_turnaround;
+        case OBJECTIVE_RESPONSE: return result->avg_response;
+        case OBJECTIVE_WAITING: return result->avg_waiting;
+        default: return result->switch_overhead;
+    }
+}
+/* Runs round_robin() for one quantum inside a worker process
+ * Pins the worker to a core and runs it in a private working directory,
+ * so parallel workers do not contend for the tasks' output files
+ */
+void run_sweep_worker(Process processes[], int n, QuantumResult* result, int cpu) {
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(cpu, &cpus);
+    if (sched_setaffinity(0, sizeof(cpus), &cpus) != 0) {
+        perror("sched_setaffinity failed");
+    }
 
-            double actual_exec_time = (now.tv_sec - start.tv_sec) * 1000.0 + 
-                                    (now.tv_nsec - start.tv_nsec) / 1000000.0;
-            actual_exec_time = actual_exec_time > exec_time ? exec_time : actual_exec_time;
+    /* Only the built-in tasks' files move; commands still run from here */
+    if (getcwd(command_dir, sizeof(command_dir)) == NULL) {
+        command_dir[0] = '\0';
+    }
 
-            current_time += actual_exec_time;
-            processes[i].remaining_time -= actual_exec_time;
+    char workdir[] = "/tmp/process-scheduler-sweep-XXXXXX";
+    if (mkdtemp(workdir) == NULL || chdir(workdir) != 0) {
+        perror("Cannot create sweep working directory");
+        exit(1);
+    }
 
-            record_event(processes[i].task_type, processes[i].process_name, 
-                        start_time, current_time);
+    freopen("/dev/null", "w", stdout);
+    freopen("/dev/null", "w", stderr);
+    live_metrics = NULL;
+
+    Process copy[MAX_PROCESSES];
+    memcpy(copy, processes, sizeof(Process) * n);
+    int status = round_robin(copy, n, result->quantum, 0);
+
+    unlink("output.txt");
+    unlink("os_project.db");
+    unlink("os_project.db-journal");
+    if (chdir("/") == 0) rmdir(workdir);
+    if (status != 0) exit(1);
+
+    result->avg_turnaround = stream_stats.turnaround.mean;
+    result->avg_waiting = stream_stats.waiting.mean;
+    result->avg_response = stream_stats.response.mean;
+    result->switches = switch_stats.switches;
+    result->switch_overhead = switch_stats.latency_samples > 0 ?
+        switch_stats.total_latency / switch_stats.latency_samples * switch_stats.switches : 0;
+    result->valid = 1;
+    exit(0);
+}
+/* Evaluates a batch of quanta in parallel, one worker per allowed core
+ * A new worker takes the core freed by the worker that finished, so no
+ * two timed runs share a core; returns the number of results now stored
+ */
+int run_sweep_batch(Process processes[], int n, QuantumResult* results, int count,
+                    const int quanta[], int batch) {
+    int cores[MAX_SWEEP_POINTS];
+    pid_t core_pid[MAX_SWEEP_POINTS];
+    int core_count = 0;
+
+    cpu_set_t allowed;
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE && core_count < MAX_SWEEP_POINTS; cpu++) {
+            if (CPU_ISSET(cpu, &allowed)) cores[core_count++] = cpu;
         }
-
-        if (!work_done) {
-            double next_arrival = __DBL_MAX__;
-            for (int i = 0; i < n; i++) {
-                if (!terminated[i] && processes[i].arrival_time > current_time) {
-                    next_arrival = (next_arrival < processes[i].arrival_time) ? 
-                                  next_arrival : processes[i].arrival_time;
+    }
+    if (core_count == 0) {
+        cores[0] = sched_getcpu() >= 0 ? sched_getcpu() : 0;
+        core_count = 1;
+    }
+    memset(core_pid, 0, sizeof(core_pid));
+
+    int running = 0;
+    for (int b = 0; b < batch; b++) {
+        while (running == core_count) {
+            pid_t done = wait(NULL);
+            if (done < 0) break;
+            for (int c = 0; c < core_count; c++) {
+                if (core_pid[c] == done) {
+                    core_pid[c] = 0;
+                    running--;
                 }
             }
-            if (next_arrival != __DBL_MAX__) {
-                current_time = next_arrival;
-            }
         }
-    }
+        if (running == core_count) break;
 
-    for (int i = 0; i < n; i++) {
+        int slot = 0;
+        while (core_pid[slot] != 0) slot++;
 
-        processes[i].turnaround_time = processes[i].completion_time - processes[i].arrival_time;
+        QuantumResult* result = &results[count + b];
+        memset(result, 0, sizeof(*result));
+        result->quantum = quanta[b];
+        printf("Evaluating quantum %d ms on CPU %d...\n", quanta[b], cores[slot]);
+        fflush(stdout);
 
-        processes[i].waiting_time = processes[i].turnaround_time - processes[i].burst_time;
+        pid_t pid = fork();
+        if (pid == 0) {
+            run_sweep_worker(processes, n, result, cores[slot]);
+        } else if (pid > 0) {
+            core_pid[slot] = pid;
+            running++;
+        }
+    }
+    while (running > 0 && wait(NULL) > 0) {
+        running--;
     }
 
-    free(first_execution_time);
-    free(terminated);
-    munmap(process_control, sizeof(ProcessControl));
+    return count + batch;
 }
-/* Implements Shortest Job First scheduling algorithm
- * Executes processes ordered by burst time
+/* Prints a horizontal bar chart of one metric against the quantum
  */
-void sjf(Process processes[], int n) {
-    printf("\nExecuting Shortest Job First Scheduling...\n");
-    event_count = 0;
+void print_sweep_plot(const char* title, QuantumResult results[], int count, int metric) {
+    double max_value = 0;
+    for (int i = 0; i < count; i++) {
+        if (results[i].valid && sweep_metric(&results[i], metric) > max_value) {
+            max_value = sweep_metric(&results[i], metric);
+        }
+    }
 
-    process_control = mmap(NULL, sizeof(ProcessControl), 
-                         PROT_READ | PROT_WRITE, 
-                         MAP_SHARED | MAP_ANONYMOUS, -1, 0);
-    if (process_control == MAP_FAILED) {
+    printf("\n%s vs Quantum:\n", title);
+    for (int i = 0; i < count; i++) {
+        if (!results[i].valid) continue;
+        double value = sweep_metric(&results[i], metric);
+        int width = max_value > 0 ? (int)(value / max_value * SWEEP_PLOT_WIDTH + 0.5) : 0;
+        printf("%6d ms | ", results[i].quantum);
+        for (int j = 0; j < width; j++) printf("#");
+        for (int j = width; j < SWEEP_PLOT_WIDTH; j++) printf(" ");
+        printf(" %.2f\n", value);
+    }
+}
+/* Sweeps round robin over a geometric grid of quanta and refines
+ * around the best one, then reports the quantum that optimizes the objective
+ */
+void tune_round_robin(Process processes[], int n, int min_quantum, int max_quantum,
+                      int grid_points, SweepObjective objective) {
+    printf("\nSweeping Round Robin time quantum from %d to %d ms...\n", min_quantum, max_quantum);
+
+    QuantumResult* results = mmap(NULL, sizeof(QuantumResult) * MAX_SWEEP_POINTS, 
+                                PROT_READ | PROT_WRITE, 
+                                MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (results == MAP_FAILED) {
         perror("mmap failed");
         return;
     }
 
-    double current_time = 0;
-    int completed = 0;
-    int* completed_processes = (int*)calloc(n, sizeof(int));
-
-    while (completed < n) {
-        int shortest = -1;
-        double shortest_burst = __DBL_MAX__;
-
-        for (int i = 0; i < n; i++) {
-            if (!completed_processes[i] && 
-                processes[i].arrival_time <= current_time && 
-                processes[i].burst_time < shortest_burst) {
-                shortest_burst = processes[i].burst_time;
-                shortest = i;
+    int quanta[MAX_SWEEP_POINTS];
+    int batch = 0;
+    for (int g = 0; g < grid_points; g++) {
+        double ratio = grid_points > 1 ? (double)g / (grid_points - 1) : 0;
+        int quantum = (int)(min_quantum * pow((double)max_quantum / min_quantum, ratio) + 0.5);
+        if (batch == 0 || quantum != quanta[batch - 1]) {
+            quanta[batch++] = quantum;
+        }
+    }
+    int count = run_sweep_batch(processes, n, results, 0, quanta, batch);
+
+    for (int round = 0; round < SWEEP_REFINE_ROUNDS; round++) {
+        /* Sort by quantum so the best run's neighbours are adjacent */
+        for (int i = 0; i < count - 1; i++) {
+            for (int j = 0; j < count - i - 1; j++) {
+                if (results[j].quantum > results[j+1].quantum) {
+                    QuantumResult temp = results[j];
+                    results[j] = results[j+1];
+                    results[j+1] = temp;
+                }
             }
         }
 
-        if (shortest == -1) {
-            double next_arrival = __DBL_MAX__;
-            for (int i = 0; i < n; i++) {
-                if (!completed_processes[i] && processes[i].arrival_time > current_time) {
-                    if (processes[i].arrival_time < next_arrival) {
-                        next_arrival = processes[i].arrival_time;
-                    }
-                }
+        int best = -1;
+        for (int i = 0; i < count; i++) {
+            if (results[i].valid && (best == -1 || 
+                sweep_metric(&results[i], objective) < sweep_metric(&results[best], objective))) {
+                best = i;
             }
-            if (next_arrival != __DBL_MAX__) {
-                sleep_ms(next_arrival - current_time);
-                current_time = next_arrival;
+        }
+        if (best == -1) break;
+
+        batch = 0;
+        int neighbours[2] = {best - 1, best + 1};
+        for (int k = 0; k < 2; k++) {
+            int j = neighbours[k];
+            if (j < 0 || j >= count) continue;
+            int quantum = (int)(sqrt((double)results[best].quantum * results[j].quantum) + 0.5);
+            if (quantum != results[best].quantum && quantum != results[j].quantum &&
+                count + batch < MAX_SWEEP_POINTS) {
+                quanta[batch++] = quantum;
             }
-            continue;
         }
+        if (batch == 0) break;
 
-        printf("Starting %s at time %.2f ms\n", 
-               processes[shortest].process_name, current_time);
+        printf("Refining around %d ms...\n", results[best].quantum);
+        count = run_sweep_batch(processes, n, results, count, quanta, batch);
+    }
 
-        if (processes[shortest].first_run) {
-            processes[shortest].first_run = 0;
+    for (int i = 0; i < count - 1; i++) {
+        for (int j = 0; j < count - i - 1; j++) {
+            if (results[j].quantum > results[j+1].quantum) {
+                QuantumResult temp = results[j];
+                results[j] = results[j+1];
+                results[j+1] = temp;
+            }
         }
+    }
 
-        process_control->should_run = 1;
-        process_control->progress = 0;
-        process_control->quantum = processes[shortest].burst_time;  
-        process_control->isPreemptive=0;
+    printf("\nQuantum Sweep Results:\n");
+    printf("%-10s %-12s %-12s %-12s %-10s %-12s\n",
+           "Quantum", "Turnaround", "Waiting", "Response", "Switches", "Overhead");
+    int best = -1;
+    for (int i = 0; i < count; i++) {
+        if (!results[i].valid) {
+            printf("%-10d (run failed)\n", results[i].quantum);
+            continue;
+        }
+        printf("%-10d %-12.2f %-12.2f %-12.2f %-10d %-12.3f\n",
+               results[i].quantum, results[i].avg_turnaround, results[i].avg_waiting,
+               results[i].avg_response, results[i].switches, results[i].switch_overhead);
+        if (best == -1 || sweep_metric(&results[i], objective) < sweep_metric(&results[best], objective)) {
+            best = i;
+        }
+    }
 
-        double start_time = current_time;
-        create_process(&processes[shortest]);
+    print_sweep_plot("Average Turnaround (ms)", results, count, OBJECTIVE_TURNAROUND);
+    print_sweep_plot("Average Response (ms)", results, count, OBJECTIVE_RESPONSE);
+    print_sweep_plot("Switch Overhead (ms)", results, count, 0);
 
-        int status;
-        struct timespec start_ts, current_ts;
-        clock_gettime(CLOCK_MONOTONIC, &start_ts);
+    if (best != -1) {
+        const char* objective_names[] = {"", "turnaround", "response", "waiting"};
+        printf("\nBest quantum for %s time: %d ms (%.2f ms)\n",
+               objective_names[objective], results[best].quantum,
+               sweep_metric(&results[best], objective));
+    }
 
-        while (1) {
-            pid_t result = waitpid(processes[shortest].pid, &status, WNOHANG);
-            if (result > 0) break;  
+    munmap(results, sizeof(QuantumResult) * MAX_SWEEP_POINTS);
+}
+/* Structure holding the outcome of one load step for one scheduler
+ * Written by the worker process into shared memory
+ */
+typedef struct {
+    double offered_rate;               // Target arrival rate (jobs/s)
+    double arrival_rate;               // Arrival rate actually generated (jobs/s)
+    int jobs;                          // Jobs injected
+    int valid;                         // Set once the worker has finished
+    double throughput;                 // Completions per second
+    double mean_latency;               // Mean turnaround (ms)
+    double p50, p95, p99;              // Turnaround percentiles, P-square estimates (ms)
+    double avg_queue;                  // Time-averaged ready queue length
+    int max_queue;                     // Longest ready queue
+    int series[QUEUE_SERIES_POINTS];   // Ready queue length over time
+    int series_count;                  // Points stored in series
+} LoadResult;
+
+/* Generates an open-loop job stream for one load step
+ * Arrivals follow a Poisson process, or Poisson-arriving batches when bursty,
+ * and service times are exponential around the mean
+ */
+int generate_load(Process jobs[], double rate, double window_ms, double mean_service_ms,
+                  int bursty, unsigned short rng[3]) {
+    int count = 0;
+    double t = 0;
+    double mean_batch = bursty ? 4.0 : 1.0;
+
+    while (count < MAX_LOAD_JOBS) {
+        t += -log(1.0 - erand48(rng)) * 1000.0 * mean_batch / rate;
+        if (t >= window_ms) break;
+
+        int batch = 1;
+        if (bursty) {
+            while (erand48(rng) < 1.0 - 1.0 / mean_batch) batch++;
+        }
 
-            clock_gettime(CLOCK_MONOTONIC, &current_ts);
-            usleep(1000);  
+        for (int b = 0; b < batch && count < MAX_LOAD_JOBS; b++) {
+            Process* p = &jobs[count];
+            memset(p, 0, sizeof(Process));
+            if (snprintf(p->process_name, sizeof(p->process_name), "J%d", count + 1) >=
+                (int)sizeof(p->process_name)) {
+                return count;  /* No distinct job name left */
+            }
+            strcpy(p->task_type, "spin");
+            p->task_function = task_spin;
+            p->arrival_time = (int)t;
+            p->service_time = -log(1.0 - erand48(rng)) * mean_service_ms;
+            if (p->service_time < 1) p->service_time = 1;
+            p->burst_time = p->service_time;
+            p->remaining_time = p->service_time;
+            p->first_run = 1;
+            count++;
         }
+    }
+    return count;
+}
 
-        clock_gettime(CLOCK_MONOTONIC, &current_ts);
-        double elapsed = (current_ts.tv_sec - start_ts.tv_sec) * 1000.0 + 
-                        (current_ts.tv_nsec - start_ts.tv_nsec) / 1000000.0;
+/* Runs one scheduler over a job stream inside a worker process
+ * Silences the per-dispatch output and stores the metrics. Throughput is
+ * measured over the injection window, or until the last completion if later
+ */
+void run_load_worker(Process jobs[], int count, int algorithm, int time_quantum_ms,
+                     double window_ms, LoadResult* result) {
+    freopen("/dev/null", "w", stdout);
+    live_metrics = NULL;
+
+    int status;
+    switch (algorithm) {
+        case 1: status = fcfs(jobs, count, 0); break;
+        case 2: status = round_robin(jobs, count, time_quantum_ms, 0); break;
+        default: status = sjf(jobs, count, 0); break;
+    }
+    if (status != 0) exit(1);
 
-        current_time += elapsed;
-        record_event(processes[shortest].task_type, 
-                    processes[shortest].process_name, 
-                    start_time, current_time);
+    double duration = window_ms;
+    for (int i = 0; i < count; i++) {
+        if (jobs[i].completion_time > duration) duration = jobs[i].completion_time;
+    }
+
+    result->jobs = count;
+    result->throughput = duration > 0 ? count * 1000.0 / duration : 0;
+    result->mean_latency = stream_stats.turnaround.mean;
+    running_stats_quantiles(&stream_stats.turnaround, &result->p50, &result->p95, &result->p99);
+    result->avg_queue = queue_stats.duration > 0 ? queue_stats.area / queue_stats.duration : 0;
+    result->max_queue = queue_stats.max_length;
+    memcpy(result->series, queue_stats.series, sizeof(result->series));
+    result->series_count = queue_stats.series_count;
+    result->valid = 1;
+    exit(0);
+}
+
+/* Prints queue length over time as a one-line sparkline
+ */
+void print_queue_sparkline(const LoadResult* result) {
+    const char levels[] = " .:-=+*#%@";
+    int top = (int)strlen(levels) - 1;
+    for (int k = 0; k < result->series_count; k++) {
+        int level = result->max_queue > 0 ? result->series[k] * top / result->max_queue : 0;
+        putchar(levels[level]);
+    }
+}
 
-        processes[shortest].completion_time = current_time;
-        processes[shortest].turnaround_time = processes[shortest].completion_time - 
-                                            processes[shortest].arrival_time;
-        processes[shortest].waiting_time = processes[shortest].turnaround_time - 
-                                         processes[shortest].burst_time;
+/* Ramps an open-loop arrival rate against FCFS, RR and SJF
+ * Reports throughput, latency percentiles and queue length per step,
+ * and the knee where each scheduler stops keeping up with the offered load
+ */
+void run_load_test(double start_rate, double end_rate, int steps, double window_ms,
+                   double mean_service_ms, int bursty, int time_quantum_ms) {
+    const char* names[] = {"", "FCFS", "RR", "SJF"};
 
-        completed_processes[shortest] = 1;
-        completed++;
+    printf("\nOpen-loop load test: %s arrivals, mean service %.1f ms, %.0f ms window\n",
+           bursty ? "bursty" : "Poisson", mean_service_ms, window_ms);
 
-        printf("Completed %s at time %.2f ms\n", 
-               processes[shortest].process_name, current_time);
+    LoadResult* results = mmap(NULL, sizeof(LoadResult) * 3 * MAX_LOAD_STEPS, 
+                             PROT_READ | PROT_WRITE, 
+                             MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (results == MAP_FAILED) {
+        perror("mmap failed");
+        return;
     }
+    memset(results, 0, sizeof(LoadResult) * 3 * MAX_LOAD_STEPS);
 
-    free(completed_processes);
-    munmap(process_control, sizeof(ProcessControl));
+    Process* jobs = (Process*)calloc(MAX_LOAD_JOBS, sizeof(Process));
+
+    for (int step = 0; step < steps; step++) {
+        double rate = steps > 1 ? start_rate + (end_rate - start_rate) * step / (steps - 1) : start_rate;
+
+        for (int algorithm = 1; algorithm <= 3; algorithm++) {
+            /* Same seed per step so every scheduler sees the same job stream */
+            unsigned short rng[3] = {(unsigned short)simulation_seed,
+                                     (unsigned short)(simulation_seed >> 16),
+                                     (unsigned short)step};
+            int count = generate_load(jobs, rate, window_ms, mean_service_ms, bursty, rng);
+
+            LoadResult* result = &results[(algorithm - 1) * MAX_LOAD_STEPS + step];
+            result->offered_rate = rate;
+            result->arrival_rate = count * 1000.0 / window_ms;
+
+            printf("Running %s at %.1f jobs/s (%d jobs)...\n", names[algorithm], rate, count);
+            fflush(stdout);
+            if (count == 0) continue;
+
+            pid_t pid = fork();
+            if (pid == 0) {
+                run_load_worker(jobs, count, algorithm, time_quantum_ms, window_ms, result);
+            } else if (pid > 0) {
+                waitpid(pid, NULL, 0);
+            }
+        }
+    }
+
+    for (int algorithm = 1; algorithm <= 3; algorithm++) {
+        LoadResult* rows = &results[(algorithm - 1) * MAX_LOAD_STEPS];
+
+        printf("\n%s:\n", names[algorithm]);
+        printf("%-10s %-10s %-12s %-10s %-10s %-10s %-10s %-10s %-6s\n",
+               "Rate", "Arrivals", "Throughput", "Mean", "p50", "p95", "p99", "AvgQueue", "MaxQ");
+
+        int knee = -1;
+        double base_p95 = -1;
+        for (int step = 0; step < steps; step++) {
+            LoadResult* r = &rows[step];
+            if (!r->valid) continue;
+            printf("%-10.1f %-10.2f %-12.2f %-10.2f %-10.2f %-10.2f %-10.2f %-10.2f %-6d\n",
+                   r->offered_rate, r->arrival_rate, r->throughput, r->mean_latency,
+                   r->p50, r->p95, r->p99, r->avg_queue, r->max_queue);
+
+            if (base_p95 < 0) base_p95 = r->p95;
+            if (knee == -1 && (r->throughput < KNEE_THROUGHPUT_RATIO * r->arrival_rate ||
+                               r->p95 > KNEE_LATENCY_FACTOR * base_p95)) {
+                knee = step;
+            }
+        }
+
+        printf("Queue length over time:\n");
+        for (int step = 0; step < steps; step++) {
+            if (!rows[step].valid) continue;
+            printf("%8.1f/s |", rows[step].offered_rate);
+            print_queue_sparkline(&rows[step]);
+            printf("| max %d\n", rows[step].max_queue);
+        }
+
+        if (knee == -1) {
+            printf("No saturation up to %.1f jobs/s\n", rows[steps - 1].offered_rate);
+        } else if (knee == 0) {
+            printf("Saturated already at %.1f jobs/s\n", rows[0].offered_rate);
+        } else {
+            printf("Knee: keeps up to %.1f jobs/s, saturates at %.1f jobs/s\n",
+                   rows[knee - 1].offered_rate, rows[knee].offered_rate);
+        }
+    }
+
+    free(jobs);
+    munmap(results, sizeof(LoadResult) * 3 * MAX_LOAD_STEPS);
 }
-/* Prints detailed statistics for all processes
- * Shows timing metrics and generates Gantt chart
+/* Top-like viewer for a running simulation
+ * Reads snapshots of the metrics segment without blocking the scheduler
  */
-void print_stats(Process processes[], int n) {
-    printf("\nProcess Statistics:\n");
-    printf("%-8s %-8s %-12s %-12s %-12s %-12s %-12s %-12s\n",
-           "Process", "PID", "Task", "Arrival", "Burst", "Completion", "Turnaround", "Waiting");
-    printf("---------------------------------------------------------------------------------------\n");
+int run_monitor() {
+    const char* state_names[] = {"new", "ready", "running", "blocked", "done"};
+    LiveMetrics* metrics = NULL;
+    LiveMetrics snapshot;
+
+    while (1) {
+        if (metrics == NULL) {
+            int fd = shm_open(METRICS_SHM_NAME, O_RDONLY, 0);
+            if (fd >= 0) {
+                metrics = mmap(NULL, sizeof(LiveMetrics), PROT_READ, MAP_SHARED, fd, 0);
+                close(fd);
+                if (metrics == MAP_FAILED) metrics = NULL;
+            }
+        }
+
+        printf("\033[H\033[2J");
+        if (metrics == NULL) {
+            printf("Waiting for a scheduler started with --metrics...\n");
+            fflush(stdout);
+            sleep_ms(MONITOR_REFRESH_MS);
+            continue;
+        }
+
+        read_live_metrics(metrics, &snapshot);
+
+        printf("Scheduler %d  %s  %s  elapsed %.2f ms\n",
+               snapshot.scheduler_pid, snapshot.policy,
+               snapshot.active ? "running" : "finished", snapshot.elapsed);
+        printf("Completed: %d/%d  Ready: %d  Blocked: %d  Switches: %d (%.1f/s)\n\n",
+               snapshot.completed, snapshot.process_count, snapshot.ready_count,
+               snapshot.blocked_count, snapshot.switches, snapshot.switches_per_sec);
+        printf("%-8s %-14s %-10s %-10s %-12s\n", "Process", "Task", "State", "Progress", "CPU (ms)");
+
+        int published = snapshot.process_count < METRICS_MAX_PROCESSES ?
+                        snapshot.process_count : METRICS_MAX_PROCESSES;
+        for (int i = 0; i < published; i++) {
+            ProcessMetrics* entry = &snapshot.processes[i];
+            int state = entry->state >= PROC_NEW && entry->state <= PROC_DONE ? entry->state : PROC_NEW;
+            printf("%-8s %-14s %-10s %-10d %-12.2f%s\n",
+                   entry->process_name, entry->task_type, state_names[state],
+                   entry->progress, entry->cpu_time, i == snapshot.running ? "  <" : "");
+        }
+        fflush(stdout);
 
-    double avg_turnaround = 0, avg_waiting = 0;
+        /* The scheduler may exit and unlink the segment between runs */
+        if (kill(snapshot.scheduler_pid, 0) != 0) {
+            munmap(metrics, sizeof(LiveMetrics));
+            metrics = NULL;
+        }
+        sleep_ms(MONITOR_REFRESH_MS);
+    }
+    return 0;
+}
+/* Looks up the cached burst estimate for an external command
+ * Returns -1 when the command has not been run before
+ */
+double lookup_burst_estimate(const char* command) {
+    FILE* fp = fopen(BURST_HISTORY_FILE, "r");
+    if (fp == NULL) return -1;
+
+    double estimate = -1;
+    double cached;
+    int runs;
+    char cached_command[MAX_COMMAND_LENGTH];
+    while (fscanf(fp, "%lf %d %255[^\n]", &cached, &runs, cached_command) == 3) {
+        if (strcmp(cached_command, command) == 0) {
+            estimate = cached;
+        }
+    }
+
+    fclose(fp);
+    return estimate;
+}
+
+/* Folds the observed CPU time of external tasks into the burst history
+ * Uses an exponential average so recent runs weigh BURST_HISTORY_ALPHA
+ */
+void update_burst_history(Process processes[], int n) {
+    double estimates[MAX_PROCESSES * 4];
+    int run_counts[MAX_PROCESSES * 4];
+    char commands[MAX_PROCESSES * 4][MAX_COMMAND_LENGTH];
+    int count = 0;
+    int updated = 0;
+
+    FILE* fp = fopen(BURST_HISTORY_FILE, "r");
+    if (fp != NULL) {
+        while (count < MAX_PROCESSES * 4 &&
+               fscanf(fp, "%lf %d %255[^\n]", &estimates[count], &run_counts[count],
+                      commands[count]) == 3) {
+            count++;
+        }
+        fclose(fp);
+    }
 
     for (int i = 0; i < n; i++) {
-        if (processes[i].waiting_time<0){
-            processes[i].waiting_time=0;
+        /* Skip built-ins and commands that never started */
+        if (processes[i].command[0] == '\0' || processes[i].pid == 0) continue;
+
+        double observed = processes[i].burst_time - processes[i].remaining_time;
+        int k;
+        for (k = 0; k < count; k++) {
+            if (strcmp(commands[k], processes[i].command) == 0) break;
         }
-        printf("%-8s %-8d %-12s %-12d %-12.2f %-12.2f %-12.2f %-12.2f\n",
-               processes[i].process_name,
-               processes[i].pid,
-               processes[i].task_type,
-               processes[i].arrival_time,
-               processes[i].burst_time,
-               processes[i].completion_time,
-               processes[i].turnaround_time,
-               processes[i].waiting_time);
+        if (k == count) {
+            if (count == MAX_PROCESSES * 4) {
+                /* Drop the oldest entry to make room */
+                memmove(&estimates[0], &estimates[1], (count - 1) * sizeof(estimates[0]));
+                memmove(&run_counts[0], &run_counts[1], (count - 1) * sizeof(run_counts[0]));
+                memmove(&commands[0], &commands[1], (count - 1) * sizeof(commands[0]));
+                count--;
+            }
+            k = count++;
+            strcpy(commands[k], processes[i].command);
+            estimates[k] = observed;
+            run_counts[k] = 1;
+        } else {
+            estimates[k] = BURST_HISTORY_ALPHA * observed + (1 - BURST_HISTORY_ALPHA) * estimates[k];
+            run_counts[k]++;
+        }
+        updated = 1;
+    }
 
-        avg_turnaround += processes[i].turnaround_time;
-        avg_waiting += processes[i].waiting_time;
+    if (!updated) return;
+
+    fp = fopen(BURST_HISTORY_FILE, "w");
+    if (fp == NULL) {
+        perror("Cannot write burst history");
+        return;
     }
+    for (int k = 0; k < count; k++) {
+        fprintf(fp, "%.2f %d %s\n", estimates[k], run_counts[k], commands[k]);
+    }
+    fclose(fp);
+}
 
-    printf("\nAverage Metrics:\n");
-    printf("Turnaround Time: %.2f ms\n", avg_turnaround/n);
-    printf("Waiting Time: %.2f ms\n", avg_waiting/n);
+/* Initializes a process that runs an external command
+ * Takes the burst time from the cached history instead of measuring it
+ */
+void initialize_external_process(Process* p, const char* command, int arrival_time_ms,
+                                 int process_num) {
+    p->task_function = NULL;
+    strcpy(p->task_type, "external");
+    snprintf(p->command, sizeof(p->command), "%s", command);
+    sprintf(p->process_name, "P%d", process_num);  
+    p->arrival_time = arrival_time_ms;
 
-    print_gantt_chart();
+    p->burst_time = lookup_burst_estimate(command);
+    if (p->burst_time < 0) {
+        p->burst_time = DEFAULT_BURST_ESTIMATE_MS;
+        printf("No burst history for %s (%s), assuming %.2f ms\n", p->process_name, command, p->burst_time);
+    } else {
+        printf("Cached burst estimate for %s (%s): %.2f ms\n", p->process_name, command, p->burst_time);
+    }
+    p->remaining_time = p->burst_time;
+    p->completion_time = 0;
+    p->waiting_time = 0;
+    p->turnaround_time = 0;
+    p->response_time = 0;
+    p->service_time = 0;
+    p->pid = 0;
+    p->is_active = 0;
+    p->cgroup_attached = 0;
+    p->first_run = 1;
 }
 /* Handles process type selection and initialization
  * Provides user interface for process configuration
@@ -780,9 +3248,10 @@ void select_process(Process* p, int index) {
     printf("2. Console Echo\n");
     printf("3. Compute\n");
     printf("4. Add record to database\n"); 
+    printf("5. External command\n");
 
     int choice;
-    printf("Select process type (1-4): ");
+    printf("Select process type (1-5): ");
     scanf("%d", &choice);
 
     int arrival_time_ms;
@@ -802,6 +3271,13 @@ void select_process(Process* p, int index) {
        case 4:  
             initialize_process(p, task_db_write, "db_write", arrival_time_ms, index + 1);
             break;
+        case 5: {
+            char command[MAX_COMMAND_LENGTH];
+            printf("Enter command line: ");
+            scanf(" %255[^\n]", command);
+            initialize_external_process(p, command, arrival_time_ms, index + 1);
+            break;
+        }
         default:
             printf("Invalid choice! Defaulting to compute process.\n");
             initialize_process(p, task_compute, "compute", arrival_time_ms, index + 1);
@@ -823,7 +3299,64 @@ void sort_processes_by_arrival_time(Process processes[], int n) {
     }
 }
 
-int main() {
+int main(int argc, char* argv[]) {
+    const char* record_path = NULL;
+    int load_test = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            record_path = argv[++i];
+        } else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            return replay_from_log(argv[++i]);
+        } else if (strcmp(argv[i], "--metrics") == 0) {
+            live_metrics = create_live_metrics();
+            if (live_metrics == NULL) return 1;
+            atexit(unlink_live_metrics);
+        } else if (strcmp(argv[i], "--monitor") == 0) {
+            return run_monitor();
+        } else if (strcmp(argv[i], "--load-test") == 0) {
+            load_test = 1;
+        } else if (strcmp(argv[i], "--cgroup") == 0) {
+            if (cgroup_backend_init() != 0) {
+                fprintf(stderr, "cgroup v2 backend unavailable, preempting with signals\n");
+            }
+        } else {
+            fprintf(stderr, "Usage: %s [--record FILE | --replay FILE | --load-test] [--metrics] [--cgroup]"
+                    " | --monitor\n", argv[0]);
+            return 1;
+        }
+    }
+
+    simulation_seed = (unsigned int)time(NULL);
+
+    if (load_test) {
+        double start_rate, end_rate, window_s, mean_service_ms;
+        int steps, bursty, time_quantum_ms;
+        printf("Enter mean service time (in milliseconds): ");
+        scanf("%lf", &mean_service_ms);
+        printf("Arrival pattern (1 = Poisson, 2 = bursty): ");
+        scanf("%d", &bursty);
+        printf("Enter starting arrival rate (jobs per second): ");
+        scanf("%lf", &start_rate);
+        printf("Enter final arrival rate (jobs per second): ");
+        scanf("%lf", &end_rate);
+        printf("Enter number of rate steps (max %d): ", MAX_LOAD_STEPS);
+        scanf("%d", &steps);
+        printf("Enter injection window per step (in seconds): ");
+        scanf("%lf", &window_s);
+        printf("Enter Round Robin time quantum (in milliseconds): ");
+        scanf("%d", &time_quantum_ms);
+
+        if (mean_service_ms <= 0 || start_rate <= 0 || end_rate < start_rate ||
+            steps <= 0 || steps > MAX_LOAD_STEPS || window_s <= 0 || time_quantum_ms <= 0) {
+            printf("Invalid load test parameters!\n");
+            return 1;
+        }
+        run_load_test(start_rate, end_rate, steps, window_s * MS_PER_SECOND,
+                      mean_service_ms, bursty == 2, time_quantum_ms);
+        return 0;
+    }
+
     int n;
     printf("Enter number of processes (max %d): ", MAX_PROCESSES);
     scanf("%d", &n);
@@ -854,49 +3387,105 @@ int main() {
     printf("1. First Come First Serve (FCFS)\n");
     printf("2. Round Robin (RR)\n");
     printf("3. Shortest Job First (SJF)\n");
+    printf("4. Round Robin with in-process coroutines (RR-CO)\n");
+    printf("5. Round Robin quantum sweep (auto-tune)\n");
+    printf("6. Shortest Remaining Time First (SRTF)\n");
 
     int choice;
     scanf("%d", &choice);
 
+    Process scheduled[MAX_PROCESSES];
+    memcpy(scheduled, processes, sizeof(Process) * n);
+    sort_processes_by_arrival_time(scheduled, n);  
+
+    int time_quantum = 0;
+    int io_aware = 0;
+
+    if (choice == 2 || choice == 6) {
+        int valid=0;
+        while (!valid){
+        printf("Enter time quantum (in milliseconds): ");
+        scanf("%d", &time_quantum);
+        if (time_quantum>0)
+        valid=1;
+        else
+        printf("Invalid time quantum.\n");
+        }
+    }
+
+    if ((choice >= 1 && choice <= 3) || choice == 6) {
+        printf("Model blocking I/O (1 = yes, 0 = no): ");
+        scanf("%d", &io_aware);
+    }
+
+    if (record_path != NULL && ((choice >= 1 && choice <= 4) || choice == 6) &&
+        begin_schedule_log(record_path, scheduled, n) != 0) {
+        return 1;
+    }
+
+    int status = 0;
     switch(choice) {
-        case 1: {
-            Process fcfs_processes[MAX_PROCESSES];
-            memcpy(fcfs_processes, processes, sizeof(Process) * n);
-            sort_processes_by_arrival_time(fcfs_processes, n);  
-            fcfs(fcfs_processes, n);
-            print_stats(fcfs_processes, n);
+        case 1:
+            status = fcfs(scheduled, n, io_aware);
             break;
-        }
-        case 2: {
-            int time_quantum_ms;
+        case 2:
+            status = round_robin(scheduled, n, time_quantum, io_aware);
+            break;
+        case 3:
+            status = sjf(scheduled, n, io_aware);
+            break;
+        case 4: {
             int valid=0;
             while (!valid){
-            printf("Enter time quantum (in milliseconds): ");
-            scanf("%d", &time_quantum_ms);
-            if (time_quantum_ms>0)
+            printf("Enter time quantum (in microseconds): ");
+            scanf("%d", &time_quantum);
+            if (time_quantum>0)
             valid=1;
             else
             printf("Invalid time quantum.\n");
             }
-            Process rr_processes[MAX_PROCESSES];
-            memcpy(rr_processes, processes, sizeof(Process) * n);
-            sort_processes_by_arrival_time(rr_processes, n);  
-            round_robin(rr_processes, n, time_quantum_ms);
-            print_stats(rr_processes, n);
+            status = round_robin_coroutine(scheduled, n, time_quantum);
             break;
         }
-        case 3: {
-            Process sjf_processes[MAX_PROCESSES];
-            memcpy(sjf_processes, processes, sizeof(Process) * n);
-            sort_processes_by_arrival_time(sjf_processes, n);  
-            sjf(sjf_processes, n);
-            print_stats(sjf_processes, n);
-            break;
+        case 5: {
+            int min_quantum, max_quantum, grid_points, objective;
+            printf("Enter minimum time quantum (in milliseconds): ");
+            scanf("%d", &min_quantum);
+            printf("Enter maximum time quantum (in milliseconds): ");
+            scanf("%d", &max_quantum);
+            printf("Enter number of grid points (max %d): ", MAX_SWEEP_POINTS - 2 * SWEEP_REFINE_ROUNDS);
+            scanf("%d", &grid_points);
+            printf("Optimize for: 1. Turnaround  2. Response  3. Waiting: ");
+            scanf("%d", &objective);
+
+            if (min_quantum <= 0 || max_quantum < min_quantum || grid_points <= 0 ||
+                grid_points > MAX_SWEEP_POINTS - 2 * SWEEP_REFINE_ROUNDS ||
+                objective < OBJECTIVE_TURNAROUND || objective > OBJECTIVE_WAITING) {
+                printf("Invalid sweep parameters!\n");
+                return 1;
+            }
+            tune_round_robin(scheduled, n, min_quantum, max_quantum, grid_points, objective);
+            return 0;
         }
+        case 6:
+            status = run_scheduler(scheduled, n, &srtf_policy, time_quantum, io_aware);
+            break;
         default:
             printf("Invalid choice!\n");
             return 1;
     }
 
+    if (status != 0) {
+        discard_schedule_log();
+        return 1;
+    }
+
+    print_stats(scheduled, n);
+    update_burst_history(scheduled, n);
+
+    if (finish_schedule_log(choice, time_quantum, io_aware, scheduled, n) != 0) {
+        return 1;
+    }
+
     return 0;
-}
\ No newline at end of file
+}